@@ -0,0 +1,408 @@
+/*
+ * Region benchmarks.  Run without arguments to run them all, or name the
+ * ones to run.  Build in release mode for meaningful numbers.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "test/utils.h"
+
+#define MIN_SECONDS 0.2
+
+/* Damage-like: overlapping boxes of all sizes */
+static void
+make_random_region (pixman_region32_t *region, int n_boxes, int size)
+{
+    pixman_box32_t *boxes = malloc (n_boxes * sizeof (pixman_box32_t));
+    int i;
+
+    for (i = 0; i < n_boxes; i++)
+    {
+	boxes[i].x1 = prng_rand_n (size);
+	boxes[i].y1 = prng_rand_n (size);
+	boxes[i].x2 = boxes[i].x1 + prng_rand_n (size / 100) + 1;
+	boxes[i].y2 = boxes[i].y1 + prng_rand_n (size / 100) + 1;
+    }
+
+    pixman_region32_init_rects (region, boxes, n_boxes);
+    free (boxes);
+}
+
+/* Text-like: rows of small glyph boxes */
+static void
+make_glyph_region (pixman_region32_t *region, int n_rows, int n_cols)
+{
+    pixman_box32_t *boxes = malloc (n_rows * n_cols * sizeof (pixman_box32_t));
+    int i, j, n = 0;
+
+    for (j = 0; j < n_rows; j++)
+    {
+	for (i = 0; i < n_cols; i++)
+	{
+	    boxes[n].x1 = i * 9 + prng_rand_n (2);
+	    boxes[n].y1 = j * 16 + prng_rand_n (3);
+	    boxes[n].x2 = boxes[n].x1 + 5 + prng_rand_n (3);
+	    boxes[n].y2 = boxes[n].y1 + 10 + prng_rand_n (3);
+	    n++;
+	}
+    }
+
+    pixman_region32_init_rects (region, boxes, n);
+    free (boxes);
+}
+
+static void
+bench_serialize_region (const char *name, pixman_region32_t *region)
+{
+    int n_rects = pixman_region32_n_rects (region);
+    size_t raw = n_rects * sizeof (pixman_box32_t);
+    size_t size = pixman_region32_serialize (region, NULL, 0);
+    uint8_t *buffer = malloc (size);
+    pixman_region32_t decoded;
+    double t, encode, decode;
+    int n;
+
+    t = gettime ();
+    for (n = 0; gettime () - t < MIN_SECONDS; n++)
+	pixman_region32_serialize (region, buffer, size);
+    encode = (gettime () - t) / n;
+
+    t = gettime ();
+    for (n = 0; gettime () - t < MIN_SECONDS; n++)
+    {
+	pixman_region32_deserialize (&decoded, buffer, size);
+	pixman_region32_fini (&decoded);
+    }
+    decode = (gettime () - t) / n;
+
+    printf ("  %-10s %8d boxes %9lu -> %8lu bytes (%5.1fx)  "
+	    "encode %7.1f MB/s  decode %7.1f MB/s\n",
+	    name, n_rects, (unsigned long)raw, (unsigned long)size,
+	    (double)raw / size, raw / encode / 1e6, raw / decode / 1e6);
+
+    free (buffer);
+}
+
+static void
+bench_serialize (void)
+{
+    pixman_region32_t region;
+
+    make_random_region (&region, 20000, 4000);
+    bench_serialize_region ("random", &region);
+    pixman_region32_fini (&region);
+
+    make_glyph_region (&region, 100, 200);
+    bench_serialize_region ("glyphs", &region);
+    pixman_region32_fini (&region);
+
+    make_random_region (&region, 200, 4000);
+    bench_serialize_region ("sparse", &region);
+    pixman_region32_fini (&region);
+}
+
+static double
+time_op (pixman_bool_t (* op) (pixman_region32_t *,
+			       pixman_region32_t *,
+			       pixman_region32_t *),
+	 pixman_region32_t *a,
+	 pixman_region32_t *b)
+{
+    pixman_region32_t result;
+    double t;
+    int n;
+
+    pixman_region32_init (&result);
+
+    t = gettime ();
+    for (n = 0; gettime () - t < MIN_SECONDS; n++)
+	op (&result, a, b);
+    t = (gettime () - t) / n;
+
+    pixman_region32_fini (&result);
+
+    return t;
+}
+
+static void
+bench_ops_regions (const char *name, pixman_region32_t *a, pixman_region32_t *b)
+{
+    printf ("  %-10s %8d x %8d boxes  union %9.1f us  intersect %9.1f us  "
+	    "subtract %9.1f us  xor %9.1f us\n",
+	    name, pixman_region32_n_rects (a), pixman_region32_n_rects (b),
+	    time_op (pixman_region32_union, a, b) * 1e6,
+	    time_op (pixman_region32_intersect, a, b) * 1e6,
+	    time_op (pixman_region32_subtract, a, b) * 1e6,
+	    time_op (pixman_region32_xor, a, b) * 1e6);
+}
+
+static void
+bench_ops (void)
+{
+    pixman_region32_t a, b;
+
+    make_random_region (&a, 20000, 4000);
+    make_random_region (&b, 20000, 4000);
+    bench_ops_regions ("random", &a, &b);
+    pixman_region32_fini (&a);
+    pixman_region32_fini (&b);
+
+    make_glyph_region (&a, 100, 200);
+    make_glyph_region (&b, 100, 200);
+    pixman_region32_translate (&b, 4, 7);
+    bench_ops_regions ("glyphs", &a, &b);
+    pixman_region32_fini (&a);
+    pixman_region32_fini (&b);
+
+    make_random_region (&a, 200, 4000);
+    make_random_region (&b, 200, 4000);
+    bench_ops_regions ("sparse", &a, &b);
+    pixman_region32_fini (&a);
+    pixman_region32_fini (&b);
+
+    /* Two narrow columns against wide bands */
+    pixman_region32_init_rect (&a, 300, 0, 40, 1600);
+    pixman_region32_union_rect (&a, &a, 1200, 0, 40, 1600);
+    make_glyph_region (&b, 100, 200);
+    bench_ops_regions ("columns", &a, &b);
+    pixman_region32_fini (&a);
+    pixman_region32_fini (&b);
+
+    /* A tall page of text and a small window over a few of its lines */
+    make_glyph_region (&a, 4000, 20);
+    pixman_region32_init_rect (&b, 20, 32000, 40, 40);
+    pixman_region32_union_rect (&b, &b, 100, 32020, 40, 40);
+    bench_ops_regions ("slice", &a, &b);
+    bench_ops_regions ("slice'", &b, &a);
+    pixman_region32_fini (&a);
+    pixman_region32_fini (&b);
+}
+
+/* Damage rectangles added to, and cut out of, a large region in place,
+ * with the rectangle functions and with full region operations.
+ */
+static void
+bench_rects_region (const char *name, pixman_region32_t *region, int size)
+{
+    pixman_region32_t a, b, rect;
+    double t, rect_time, op_time;
+    int n;
+
+    pixman_region32_init (&a);
+    pixman_region32_init (&b);
+    pixman_region32_init (&rect);
+
+    prng_srand (1);
+    pixman_region32_copy (&a, region);
+    t = gettime ();
+    for (n = 0; gettime () - t < MIN_SECONDS; n++)
+    {
+	int x = prng_rand_n (size), y = prng_rand_n (size);
+
+	if (n & 1)
+	    pixman_region32_subtract_rect (&a, &a, x, y, 20, 20);
+	else
+	    pixman_region32_union_rect (&a, &a, x, y, 20, 20);
+    }
+    rect_time = (gettime () - t) / n;
+
+    prng_srand (1);
+    pixman_region32_copy (&b, region);
+    t = gettime ();
+    for (n = 0; gettime () - t < MIN_SECONDS; n++)
+    {
+	pixman_box32_t box;
+
+	box.x1 = prng_rand_n (size);
+	box.y1 = prng_rand_n (size);
+	box.x2 = box.x1 + 20;
+	box.y2 = box.y1 + 20;
+
+	pixman_region32_reset (&rect, &box);
+	if (n & 1)
+	    pixman_region32_subtract (&b, &b, &rect);
+	else
+	    pixman_region32_union (&b, &b, &rect);
+    }
+    op_time = (gettime () - t) / n;
+
+    printf ("  %-10s %8d boxes  union/subtract_rect %9.2f us  "
+	    "union/subtract %9.2f us\n",
+	    name, pixman_region32_n_rects (region),
+	    rect_time * 1e6, op_time * 1e6);
+
+    pixman_region32_fini (&a);
+    pixman_region32_fini (&b);
+    pixman_region32_fini (&rect);
+}
+
+static void
+bench_rects (void)
+{
+    pixman_region32_t region;
+
+    make_random_region (&region, 20000, 4000);
+    bench_rects_region ("random", &region, 4000);
+    pixman_region32_fini (&region);
+
+    make_glyph_region (&region, 100, 200);
+    bench_rects_region ("glyphs", &region, 1600);
+    pixman_region32_fini (&region);
+
+    make_random_region (&region, 200, 4000);
+    bench_rects_region ("sparse", &region, 4000);
+    pixman_region32_fini (&region);
+}
+
+/* A frame's worth of damage, 300 unsorted rectangles around one spot,
+ * merged into a large region in place: one rectangle at a time, as a
+ * region, and as a batch.  After the first round the region doesn't
+ * change any more, but the work to find that out is the same.
+ */
+static void
+bench_batch_region (const char *name, pixman_region32_t *region, int size)
+{
+    pixman_box32_t boxes[300];
+    pixman_region32_t result, batch;
+    double t, one_time, region_time, batch_time;
+    int i, n;
+
+    for (i = 0; i < 300; i++)
+    {
+	boxes[i].x1 = size / 2 + prng_rand_n (size / 10);
+	boxes[i].y1 = size / 2 + prng_rand_n (size / 10);
+	boxes[i].x2 = boxes[i].x1 + prng_rand_n (30) + 1;
+	boxes[i].y2 = boxes[i].y1 + prng_rand_n (30) + 1;
+    }
+
+    pixman_region32_init (&result);
+    pixman_region32_union_rects (&result, region, boxes, 300);
+
+    t = gettime ();
+    for (n = 0; gettime () - t < MIN_SECONDS; n++)
+    {
+	for (i = 0; i < 300; i++)
+	{
+	    pixman_region32_union_rect (&result, &result, boxes[i].x1, boxes[i].y1,
+					boxes[i].x2 - boxes[i].x1,
+					boxes[i].y2 - boxes[i].y1);
+	}
+    }
+    one_time = (gettime () - t) / n;
+
+    t = gettime ();
+    for (n = 0; gettime () - t < MIN_SECONDS; n++)
+    {
+	pixman_region32_init_rects (&batch, boxes, 300);
+	pixman_region32_union (&result, &result, &batch);
+	pixman_region32_fini (&batch);
+    }
+    region_time = (gettime () - t) / n;
+
+    t = gettime ();
+    for (n = 0; gettime () - t < MIN_SECONDS; n++)
+	pixman_region32_union_rects (&result, &result, boxes, 300);
+    batch_time = (gettime () - t) / n;
+
+    printf ("  %-10s %8d boxes  union_rect x 300 %9.1f us  "
+	    "init_rects + union %9.1f us  union_rects %9.1f us\n",
+	    name, pixman_region32_n_rects (region),
+	    one_time * 1e6, region_time * 1e6, batch_time * 1e6);
+
+    pixman_region32_fini (&result);
+}
+
+static void
+bench_batch (void)
+{
+    pixman_region32_t region;
+
+    make_random_region (&region, 20000, 4000);
+    bench_batch_region ("random", &region, 4000);
+    pixman_region32_fini (&region);
+
+    make_glyph_region (&region, 100, 200);
+    bench_batch_region ("glyphs", &region, 1600);
+    pixman_region32_fini (&region);
+}
+
+/* Clip a large region to a viewport in the middle of it */
+static void
+bench_clip_region (const char *name, pixman_region32_t *region, int size)
+{
+    pixman_region32_t result;
+    double t;
+    int n;
+
+    pixman_region32_init (&result);
+
+    t = gettime ();
+    for (n = 0; gettime () - t < MIN_SECONDS; n++)
+    {
+	pixman_region32_intersect_rect (&result, region,
+					size / 2, size / 2, 256, 256);
+    }
+    t = (gettime () - t) / n;
+
+    printf ("  %-10s %8d boxes -> %6d boxes  intersect_rect %9.2f us\n",
+	    name, pixman_region32_n_rects (region),
+	    pixman_region32_n_rects (&result), t * 1e6);
+
+    pixman_region32_fini (&result);
+}
+
+static void
+bench_clip (void)
+{
+    pixman_region32_t region;
+
+    make_random_region (&region, 20000, 4000);
+    bench_clip_region ("random", &region, 4000);
+    pixman_region32_fini (&region);
+
+    make_glyph_region (&region, 100, 200);
+    bench_clip_region ("glyphs", &region, 1600);
+    pixman_region32_fini (&region);
+}
+
+typedef struct
+{
+    const char *name;
+    void      (* run) (void);
+} benchmark_t;
+
+static const benchmark_t benchmarks[] =
+{
+    { "serialize", bench_serialize },
+    { "ops",       bench_ops },
+    { "rects",     bench_rects },
+    { "batch",     bench_batch },
+    { "clip",      bench_clip },
+};
+
+int
+main (int argc, char **argv)
+{
+    int i, j;
+
+    for (i = 0; i < ARRAY_LENGTH (benchmarks); i++)
+    {
+	pixman_bool_t selected = argc < 2;
+
+	for (j = 1; j < argc; j++)
+	{
+	    if (strcmp (argv[j], benchmarks[i].name) == 0)
+		selected = TRUE;
+	}
+
+	if (!selected)
+	    continue;
+
+	prng_srand (0);
+
+	printf ("%s:\n", benchmarks[i].name);
+	benchmarks[i].run ();
+    }
+
+    return 0;
+}
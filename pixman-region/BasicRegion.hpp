@@ -0,0 +1,556 @@
+/*
+ * BasicRegion.hpp
+ *
+ * Header-only version of the pixman region algorithms, generic over
+ * the coordinate type and the box storage.  BasicRegion<int32_t>
+ * produces the same boxes as pixman_region32_t for the same
+ * operations; other widths, e.g. int16_t or int64_t, need no more
+ * than an instantiation.
+ */
+
+#ifndef BASICREGION_HPP_
+#define BASICREGION_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <limits>
+#include <vector>
+
+template <class Coord>
+struct BasicBox {
+	Coord x1, y1, x2, y2;
+};
+
+// a type wide enough for the sum of two coordinates, as
+// overflow_int_t in pixman-region.c.inc
+template <class Coord> struct BasicRegionWide;
+
+template <> struct BasicRegionWide<int16_t> {
+	typedef int32_t type;
+};
+template <> struct BasicRegionWide<int32_t> {
+	typedef int64_t type;
+};
+#ifdef __SIZEOF_INT128__
+template <> struct BasicRegionWide<int64_t> {
+	typedef __int128 type;
+};
+#endif
+
+// Storage is a sequence container of BasicBox<Coord> with size(),
+// resize(), push_back(), data() and operator[], like std::vector.
+template <class Coord,
+		class Storage = std::vector< BasicBox<Coord> > >
+class BasicRegion {
+public:
+	typedef BasicBox<Coord> Box;
+
+	/** CTORS/DTORS *******************/
+
+	BasicRegion() : m_extents(emptyBox()) {}
+
+	// a region of one box, or an empty one if the box is empty
+	explicit BasicRegion(Box const &box) : m_extents(emptyBox()) {
+		if (!isEmptyBox(box))
+		{
+			m_extents = box;
+			m_boxes.push_back(box);
+		}
+	}
+
+	/** OPERATORS ********************/
+
+	bool operator== (BasicRegion const &other) const {
+		return this->isEqual(other);
+	}
+
+	/** METHODS ********************/
+
+	void clear()
+	{
+		m_boxes.resize(0);
+		m_extents = emptyBox();
+	}
+
+	bool isEmpty() const
+	{
+		return m_boxes.size() == 0;
+	}
+
+	// returns whether this region covers exactly the same
+	// area as 'other'
+	bool isEqual(BasicRegion const &other) const
+	{
+		size_t n = m_boxes.size();
+
+		if (n != other.m_boxes.size())
+			return false;
+		for (size_t i = 0; i < n; i++)
+		{
+			if (!sameBox(m_boxes[i], other.m_boxes[i]))
+				return false;
+		}
+		return true;
+	}
+
+	Box getExtents() const
+	{
+		return m_extents;
+	}
+
+	size_t numRects() const
+	{
+		return m_boxes.size();
+	}
+
+	// the boxes, in y-x banded order; valid until the region
+	// is modified
+	Box const *getBoxes() const
+	{
+		return m_boxes.size() ? &m_boxes[0] : 0;
+	}
+
+	bool containsPoint(Coord x, Coord y) const
+	{
+		if (!boxContains(m_extents, x, y))
+			return false;
+
+		// binary search for the first box below y, as
+		// find_box_for_y does
+		size_t lo = 0, hi = m_boxes.size();
+		while (lo < hi)
+		{
+			size_t mid = lo + (hi - lo) / 2;
+			if (m_boxes[mid].y2 <= y)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		for (size_t i = lo; i < m_boxes.size(); i++)
+		{
+			Box const &box = m_boxes[i];
+			if (y < box.y1 || x < box.x1)
+				break;
+			if (x < box.x2)
+				return true;
+		}
+		return false;
+	}
+
+	// translate in place; parts moved beyond the coordinate
+	// range are clipped away
+	void translate(Coord dx, Coord dy)
+	{
+		typedef typename BasicRegionWide<Coord>::type Wide;
+		const Wide lo = std::numeric_limits<Coord>::min();
+		const Wide hi = std::numeric_limits<Coord>::max();
+		size_t n = 0;
+
+		for (size_t i = 0; i < m_boxes.size(); i++)
+		{
+			Wide x1 = clamp((Wide)m_boxes[i].x1 + dx, lo, hi);
+			Wide y1 = clamp((Wide)m_boxes[i].y1 + dy, lo, hi);
+			Wide x2 = clamp((Wide)m_boxes[i].x2 + dx, lo, hi);
+			Wide y2 = clamp((Wide)m_boxes[i].y2 + dy, lo, hi);
+
+			if (x1 < x2 && y1 < y2)
+			{
+				Box box = { (Coord)x1, (Coord)y1, (Coord)x2, (Coord)y2 };
+				m_boxes[n++] = box;
+			}
+		}
+		m_boxes.resize(n);
+		setExtents();
+	}
+
+	// return region which is union of this region with other
+	BasicRegion unionRegion(BasicRegion const &other) const
+	{
+		BasicRegion const &r1 = *this, &r2 = other;
+
+		if (&r1 == &r2 || r2.isEmpty())
+			return r1;
+		if (r1.isEmpty())
+			return r2;
+		if (r1.numRects() == 1 && subsumes(r1.m_extents, r2.m_extents))
+			return r1;
+		if (r2.numRects() == 1 && subsumes(r2.m_extents, r1.m_extents))
+			return r2;
+
+		BasicRegion result;
+		result.template op<UnionOp, true, true>(r1, r2);
+		result.m_extents.x1 = min(r1.m_extents.x1, r2.m_extents.x1);
+		result.m_extents.y1 = min(r1.m_extents.y1, r2.m_extents.y1);
+		result.m_extents.x2 = max(r1.m_extents.x2, r2.m_extents.x2);
+		result.m_extents.y2 = max(r1.m_extents.y2, r2.m_extents.y2);
+		return result;
+	}
+
+	// return region which is intersection of this region with other
+	BasicRegion intersectRegion(BasicRegion const &other) const
+	{
+		BasicRegion const &r1 = *this, &r2 = other;
+
+		if (r1.isEmpty() || r2.isEmpty() ||
+				!overlaps(r1.m_extents, r2.m_extents))
+			return BasicRegion();
+		if (&r1 == &r2)
+			return r1;
+		if (r1.numRects() == 1 && r2.numRects() == 1)
+		{
+			Box box = {
+				max(r1.m_extents.x1, r2.m_extents.x1),
+				max(r1.m_extents.y1, r2.m_extents.y1),
+				min(r1.m_extents.x2, r2.m_extents.x2),
+				min(r1.m_extents.y2, r2.m_extents.y2)
+			};
+			return BasicRegion(box);
+		}
+		if (r2.numRects() == 1 && subsumes(r2.m_extents, r1.m_extents))
+			return r1;
+		if (r1.numRects() == 1 && subsumes(r1.m_extents, r2.m_extents))
+			return r2;
+
+		BasicRegion result;
+		result.template op<IntersectOp, false, false>(r1, r2);
+		result.setExtents();
+		return result;
+	}
+
+	// return region which is a copy of this region with
+	// pieces removed where it overlaps 'other'
+	BasicRegion subtractRegion(BasicRegion const &other) const
+	{
+		BasicRegion const &r1 = *this, &r2 = other;
+
+		if (r1.isEmpty() || r2.isEmpty() ||
+				!overlaps(r1.m_extents, r2.m_extents))
+			return r1;
+		if (&r1 == &r2)
+			return BasicRegion();
+
+		BasicRegion result;
+		result.template op<SubtractOp, true, false>(r1, r2);
+		result.setExtents();
+		return result;
+	}
+
+	/** END PUBLIC *******************/
+
+private:
+
+	static constexpr Box emptyBox()
+	{
+		return Box { 0, 0, 0, 0 };
+	}
+
+	static constexpr Coord min(Coord a, Coord b)
+	{
+		return a < b ? a : b;
+	}
+
+	static constexpr Coord max(Coord a, Coord b)
+	{
+		return a > b ? a : b;
+	}
+
+	template <class Wide>
+	static constexpr Wide clamp(Wide v, Wide lo, Wide hi)
+	{
+		return v < lo ? lo : (v > hi ? hi : v);
+	}
+
+	static constexpr bool isEmptyBox(Box const &b)
+	{
+		return b.x1 >= b.x2 || b.y1 >= b.y2;
+	}
+
+	static constexpr bool sameBox(Box const &a, Box const &b)
+	{
+		return a.x1 == b.x1 && a.y1 == b.y1 &&
+			a.x2 == b.x2 && a.y2 == b.y2;
+	}
+
+	static constexpr bool overlaps(Box const &a, Box const &b)
+	{
+		return a.x1 < b.x2 && b.x1 < a.x2 &&
+			a.y1 < b.y2 && b.y1 < a.y2;
+	}
+
+	static constexpr bool subsumes(Box const &outer, Box const &inner)
+	{
+		return outer.x1 <= inner.x1 && outer.x2 >= inner.x2 &&
+			outer.y1 <= inner.y1 && outer.y2 >= inner.y2;
+	}
+
+	static constexpr bool boxContains(Box const &b, Coord x, Coord y)
+	{
+		return x >= b.x1 && x < b.x2 && y >= b.y1 && y < b.y2;
+	}
+
+	static void addBox(Storage &out, Coord x1, Coord y1, Coord x2, Coord y2)
+	{
+		Box box = { x1, y1, x2, y2 };
+		out.push_back(box);
+	}
+
+	static Box const *bandEnd(Box const *r, Box const *end)
+	{
+		Box const *e = r + 1;
+		while (e != end && e->y1 == r->y1)
+			e++;
+		return e;
+	}
+
+	static void appendNonOverlapping(Storage &out, Box const *r,
+			Box const *end, Coord y1, Coord y2)
+	{
+		for (; r != end; r++)
+			addBox(out, r->x1, y1, r->x2, y2);
+	}
+
+	// merges the band starting at curStart into the one at
+	// prevStart if they have the same boxes and touch, as
+	// pixman_coalesce; returns the start of the last band
+	static size_t coalesce(Storage &out, size_t prevStart, size_t curStart)
+	{
+		size_t n = curStart - prevStart;
+
+		if (!n || n != out.size() - curStart)
+			return curStart;
+		if (out[prevStart].y2 != out[curStart].y1)
+			return curStart;
+		for (size_t i = 0; i < n; i++)
+		{
+			if (out[prevStart + i].x1 != out[curStart + i].x1 ||
+					out[prevStart + i].x2 != out[curStart + i].x2)
+				return curStart;
+		}
+		for (size_t i = 0; i < n; i++)
+			out[prevStart + i].y2 = out[curStart].y2;
+		out.resize(curStart);
+		return prevStart;
+	}
+
+	// the overlap functions of pixman_op, as function objects
+	struct UnionOp {
+		static void apply(Storage &out, Box const *r1, Box const *r1End,
+				Box const *r2, Box const *r2End, Coord y1, Coord y2)
+		{
+			Coord x1, x2;
+
+			if (r1->x1 < r2->x1)
+			{
+				x1 = r1->x1;
+				x2 = r1->x2;
+				r1++;
+			}
+			else
+			{
+				x1 = r2->x1;
+				x2 = r2->x2;
+				r2++;
+			}
+			while (r1 != r1End || r2 != r2End)
+			{
+				Box const *&r = (r2 == r2End ||
+						(r1 != r1End && r1->x1 < r2->x1)) ? r1 : r2;
+				if (r->x1 <= x2)
+				{
+					if (x2 < r->x2)
+						x2 = r->x2;
+				}
+				else
+				{
+					addBox(out, x1, y1, x2, y2);
+					x1 = r->x1;
+					x2 = r->x2;
+				}
+				r++;
+			}
+			addBox(out, x1, y1, x2, y2);
+		}
+	};
+
+	struct IntersectOp {
+		static void apply(Storage &out, Box const *r1, Box const *r1End,
+				Box const *r2, Box const *r2End, Coord y1, Coord y2)
+		{
+			do
+			{
+				Coord x1 = max(r1->x1, r2->x1);
+				Coord x2 = min(r1->x2, r2->x2);
+
+				if (x1 < x2)
+					addBox(out, x1, y1, x2, y2);
+				if (r1->x2 == x2)
+					r1++;
+				if (r2->x2 == x2)
+					r2++;
+			}
+			while (r1 != r1End && r2 != r2End);
+		}
+	};
+
+	struct SubtractOp {
+		static void apply(Storage &out, Box const *r1, Box const *r1End,
+				Box const *r2, Box const *r2End, Coord y1, Coord y2)
+		{
+			Coord x1 = r1->x1;
+
+			do
+			{
+				if (r2->x2 <= x1)
+				{
+					r2++;
+				}
+				else if (r2->x1 <= x1 || r2->x1 < r1->x2)
+				{
+					if (r2->x1 > x1)
+						addBox(out, x1, y1, r2->x1, y2);
+					x1 = r2->x2;
+					if (x1 >= r1->x2)
+					{
+						if (++r1 != r1End)
+							x1 = r1->x1;
+					}
+					else
+					{
+						r2++;
+					}
+				}
+				else
+				{
+					if (r1->x2 > x1)
+						addBox(out, x1, y1, r1->x2, y2);
+					if (++r1 != r1End)
+						x1 = r1->x1;
+				}
+			}
+			while (r1 != r1End && r2 != r2End);
+
+			while (r1 != r1End)
+			{
+				addBox(out, x1, y1, r1->x2, y2);
+				if (++r1 != r1End)
+					x1 = r1->x1;
+			}
+		}
+	};
+
+	// the band sweep of pixman_op, with the overlap function and
+	// the handling of non-overlapping bands fixed at compile time
+	template <class Overlap, bool AppendNon1, bool AppendNon2>
+	void op(BasicRegion const &reg1, BasicRegion const &reg2)
+	{
+		Box const *r1 = reg1.getBoxes(), *r1End = r1 + reg1.numRects();
+		Box const *r2 = reg2.getBoxes(), *r2End = r2 + reg2.numRects();
+		Box const *r1BandEnd, *r2BandEnd;
+		Storage &out = m_boxes;
+		Coord ybot = min(r1->y1, r2->y1);
+		Coord ytop;
+		size_t prevBand = 0, curBand;
+
+		out.resize(0);
+
+		do
+		{
+			r1BandEnd = bandEnd(r1, r1End);
+			r2BandEnd = bandEnd(r2, r2End);
+
+			if (r1->y1 < r2->y1)
+			{
+				if (AppendNon1)
+				{
+					Coord top = max(r1->y1, ybot);
+					Coord bot = min(r1->y2, r2->y1);
+					if (top != bot)
+					{
+						curBand = out.size();
+						appendNonOverlapping(out, r1, r1BandEnd, top, bot);
+						prevBand = coalesce(out, prevBand, curBand);
+					}
+				}
+				ytop = r2->y1;
+			}
+			else if (r2->y1 < r1->y1)
+			{
+				if (AppendNon2)
+				{
+					Coord top = max(r2->y1, ybot);
+					Coord bot = min(r2->y2, r1->y1);
+					if (top != bot)
+					{
+						curBand = out.size();
+						appendNonOverlapping(out, r2, r2BandEnd, top, bot);
+						prevBand = coalesce(out, prevBand, curBand);
+					}
+				}
+				ytop = r1->y1;
+			}
+			else
+			{
+				ytop = r1->y1;
+			}
+
+			ybot = min(r1->y2, r2->y2);
+			if (ybot > ytop)
+			{
+				curBand = out.size();
+				Overlap::apply(out, r1, r1BandEnd, r2, r2BandEnd, ytop, ybot);
+				prevBand = coalesce(out, prevBand, curBand);
+			}
+
+			if (r1->y2 == ybot)
+				r1 = r1BandEnd;
+			if (r2->y2 == ybot)
+				r2 = r2BandEnd;
+		}
+		while (r1 != r1End && r2 != r2End);
+
+		if (AppendNon1 && r1 != r1End)
+			appendRest(out, prevBand, r1, r1End, ybot);
+		else if (AppendNon2 && r2 != r2End)
+			appendRest(out, prevBand, r2, r2End, ybot);
+	}
+
+	static void appendRest(Storage &out, size_t prevBand,
+			Box const *r, Box const *end, Coord ybot)
+	{
+		Box const *rBandEnd = bandEnd(r, end);
+		size_t curBand = out.size();
+
+		appendNonOverlapping(out, r, rBandEnd, max(r->y1, ybot), r->y2);
+		coalesce(out, prevBand, curBand);
+		for (r = rBandEnd; r != end; r++)
+			out.push_back(*r);
+	}
+
+	void setExtents()
+	{
+		size_t n = m_boxes.size();
+
+		if (!n)
+		{
+			m_extents = emptyBox();
+			return;
+		}
+		m_extents.x1 = m_boxes[0].x1;
+		m_extents.y1 = m_boxes[0].y1;
+		m_extents.x2 = m_boxes[n - 1].x2;
+		m_extents.y2 = m_boxes[n - 1].y2;
+		for (size_t i = 0; i < n; i++)
+		{
+			if (m_boxes[i].x1 < m_extents.x1)
+				m_extents.x1 = m_boxes[i].x1;
+			if (m_boxes[i].x2 > m_extents.x2)
+				m_extents.x2 = m_boxes[i].x2;
+		}
+	}
+
+	Storage m_boxes;
+	Box m_extents;
+};
+
+
+#endif /* BASICREGION_HPP_ */
@@ -13,6 +13,9 @@ extern "C" {
 }
 
 
+class PixmanRegionLeaf;
+template <int Op, class Left, class Right> class RegionExpr;
+
 class PixmanRegion {
 public:
 	/** CTORS/DTORS *******************/
@@ -21,11 +24,17 @@ public:
 		pixman_region32_init(&m_region);
 		clear();
 	}
+	// copies share the rectangles with the original until either
+	// is modified, so they are cheap
 	PixmanRegion(PixmanRegion const &from_region) {
 		pixman_region32_init(&m_region);
 		pixman_region32_copy(&m_region,
 				const_cast<pixman_region32_t*>(&from_region.m_region));
 	}
+	PixmanRegion(PixmanRegion &&from_region) noexcept {
+		m_region = from_region.m_region;
+		pixman_region32_init(&from_region.m_region);
+	}
 	PixmanRegion(int x, int y,
 			unsigned int width, unsigned int height) {
 		pixman_region32_init_rect(&m_region,
@@ -36,6 +45,13 @@ public:
 		pixman_region32_copy(&m_region,
 				const_cast<pixman_region32_t*>(&from_pixman_region32));
 	}
+	// evaluates a region expression such as (a | b) - (c & d),
+	// see RegionExpr below
+	template <int Op, class Left, class Right>
+	PixmanRegion(RegionExpr<Op, Left, Right> const &expr) {
+		pixman_region32_init(&m_region);
+		assignExpr(expr);
+	}
 
 	virtual ~PixmanRegion() {
 		this->freeInternal();
@@ -55,6 +71,22 @@ public:
 		return *this;
 	}
 
+	PixmanRegion& operator=(PixmanRegion&& other) noexcept {
+		if (this != &other)
+		{
+			freeInternal();
+			m_region = other.m_region;
+			pixman_region32_init(&other.m_region);
+		}
+		return *this;
+	}
+
+	template <int Op, class Left, class Right>
+	PixmanRegion& operator=(RegionExpr<Op, Left, Right> const &expr) {
+		assignExpr(expr);
+		return *this;
+	}
+
 	/** METHODS ********************/
 
 	// make this region a copy of another
@@ -79,35 +111,56 @@ public:
 	// return region which is intersection of this region with other
 	PixmanRegion intersectRegion(PixmanRegion const& other) const
 	{
-		pixman_region32_t result;
-		pixman_region32_init(&result);
-		pixman_region32_intersect(&result,
+		PixmanRegion result;
+		pixman_region32_intersect(&result.m_region,
 				const_cast<pixman_region32_t*>(&m_region),
 				const_cast<pixman_region32_t*>(&other.m_region));
-		return PixmanRegion(result);
+		return result;
 	}
 
 	// return region which is union of this region with other
 	PixmanRegion unionRegion(PixmanRegion const& other) const
 	{
-		pixman_region32_t result;
-		pixman_region32_init(&result);
-		pixman_region32_union(&result,
+		PixmanRegion result;
+		pixman_region32_union(&result.m_region,
 				const_cast<pixman_region32_t*>(&m_region),
 				const_cast<pixman_region32_t*>(&other.m_region));
-		return PixmanRegion(result);
+		return result;
 	}
 
 	// return region which is a copy of this region with
 	// pieces removed where it overlaps 'other'
 	PixmanRegion subtractRegion(PixmanRegion const& other) const
 	{
-		pixman_region32_t result;
-		pixman_region32_init(&result);
-		pixman_region32_subtract(&result,
+		PixmanRegion result;
+		pixman_region32_subtract(&result.m_region,
+				const_cast<pixman_region32_t*>(&m_region),
+				const_cast<pixman_region32_t*>(&other.m_region));
+		return result;
+	}
+
+	// return region of the pieces that are in exactly one of
+	// this region and 'other', e.g. what changed between frames
+	PixmanRegion xorRegion(PixmanRegion const& other) const
+	{
+		PixmanRegion result;
+		pixman_region32_xor(&result.m_region,
 				const_cast<pixman_region32_t*>(&m_region),
 				const_cast<pixman_region32_t*>(&other.m_region));
-		return PixmanRegion(result);
+		return result;
+	}
+
+	// return a region of at most 'maxBoxes' boxes which covers
+	// this region, adding more area only while the total added
+	// stays within 'maxExtraArea'
+	PixmanRegion simplifiedRegion(int maxBoxes,
+			uint64_t maxExtraArea = 0) const
+	{
+		PixmanRegion result;
+		pixman_region32_simplify(&result.m_region,
+				const_cast<pixman_region32_t*>(&m_region),
+				maxBoxes, maxExtraArea);
+		return result;
 	}
 
 	// returns whether this region contains point at given x,y
@@ -151,6 +204,28 @@ public:
 				const_cast<pixman_region32_t*>(&other.m_region));
 	}
 
+	// returns the number of pixels covered by the region
+	uint64_t area() const
+	{
+		return pixman_region32_area(
+				const_cast<pixman_region32_t*>(&m_region));
+	}
+
+	// returns the fraction of 'box' covered by the region
+	double coverageRatio(pixman_box32_t box) const
+	{
+		return pixman_region32_coverage_ratio(
+				const_cast<pixman_region32_t*>(&m_region), &box);
+	}
+
+	// returns a hash of the region's boxes; equal regions
+	// have equal hashes
+	uint64_t hash() const
+	{
+		return pixman_region32_hash(
+				const_cast<pixman_region32_t*>(&m_region));
+	}
+
 	pixman_box32_t getExtents()
 	{
 		pixman_box32_t* extents =
@@ -178,11 +253,242 @@ protected:
 		pixman_region32_fini(&m_region);
 	}
 
+	// the result is built aside, so the expression may refer to
+	// this region
+	template <class Expr>
+	void assignExpr(Expr const &expr)
+	{
+		pixman_region32_t result;
+		pixman_region32_init_bands(&result, expr.begin());
+		expr.end();
+		freeInternal();
+		m_region = result;
+	}
+
 private:
+	friend class PixmanRegionLeaf;
+
 	pixman_region32_t m_region;
 };
 
 
+/** EXPRESSIONS ******************/
+
+// The operators |, &, - and ^ on regions don't compute anything; they
+// build a RegionExpr that records the operator tree.  Assigning it
+// to a PixmanRegion evaluates the whole tree in one sweep over the
+// bands of the operands, without temporary regions (see the band
+// iterators in pixman-region.h).  Subtrees that the extents show to
+// be empty, or to leave the other operand unchanged, are skipped.
+//
+// An expression refers to its operand regions, so it should be
+// assigned within the statement that builds it, while they exist.
+
+enum {
+	RegionExprUnion,
+	RegionExprIntersect,
+	RegionExprSubtract,
+	RegionExprXor
+};
+
+// a region as an operand of a RegionExpr
+class PixmanRegionLeaf {
+public:
+	PixmanRegionLeaf(PixmanRegion const &region) :
+		m_region(&region.m_region), m_source() {}
+
+	pixman_box32_t extents() const
+	{
+		return m_region->extents;
+	}
+
+	pixman_region32_band_iter_t *begin() const
+	{
+		return pixman_region32_band_source_init(&m_source,
+				const_cast<pixman_region32_t*>(m_region));
+	}
+
+	void end() const {}
+
+private:
+	pixman_region32_t const *m_region;
+	mutable pixman_region32_band_source_t m_source;
+};
+
+template <int Op, class Left, class Right>
+class RegionExpr {
+public:
+	RegionExpr(Left const &left, Right const &right) :
+		m_left(left), m_right(right), m_empty(emptyRegion()),
+		m_mode(Both), m_op() {}
+
+	// bounding box of the result, possibly larger than the result
+	pixman_box32_t extents() const
+	{
+		pixman_box32_t l = m_left.extents();
+		pixman_box32_t r = m_right.extents();
+		pixman_box32_t e = { 0, 0, 0, 0 };
+
+		switch (mode(l, r))
+		{
+		case Empty:
+			return e;
+		case LeftOnly:
+			return l;
+		case RightOnly:
+			return r;
+		default:
+			break;
+		}
+		if (Op == RegionExprIntersect)
+		{
+			e.x1 = l.x1 > r.x1 ? l.x1 : r.x1;
+			e.y1 = l.y1 > r.y1 ? l.y1 : r.y1;
+			e.x2 = l.x2 < r.x2 ? l.x2 : r.x2;
+			e.y2 = l.y2 < r.y2 ? l.y2 : r.y2;
+			return e;
+		}
+		if (Op == RegionExprSubtract)
+			return l;
+		e.x1 = l.x1 < r.x1 ? l.x1 : r.x1;
+		e.y1 = l.y1 < r.y1 ? l.y1 : r.y1;
+		e.x2 = l.x2 > r.x2 ? l.x2 : r.x2;
+		e.y2 = l.y2 > r.y2 ? l.y2 : r.y2;
+		return e;
+	}
+
+	// start the sweep; end() must be called when it is done
+	pixman_region32_band_iter_t *begin() const
+	{
+		m_mode = mode(m_left.extents(), m_right.extents());
+
+		switch (m_mode)
+		{
+		case Empty:
+			return m_empty.begin();
+		case LeftOnly:
+			return m_left.begin();
+		case RightOnly:
+			return m_right.begin();
+		default:
+			break;
+		}
+
+		pixman_region32_band_iter_t *l = m_left.begin();
+		pixman_region32_band_iter_t *r = m_right.begin();
+
+		if (Op == RegionExprIntersect)
+			return pixman_region32_band_intersect_init(&m_op, l, r);
+		if (Op == RegionExprSubtract)
+			return pixman_region32_band_subtract_init(&m_op, l, r);
+		if (Op == RegionExprXor)
+			return pixman_region32_band_xor_init(&m_op, l, r);
+		return pixman_region32_band_union_init(&m_op, l, r);
+	}
+
+	void end() const
+	{
+		if (m_mode == Both)
+			pixman_region32_band_op_fini(&m_op);
+		if (m_mode == Both || m_mode == LeftOnly)
+			m_left.end();
+		if (m_mode == Both || m_mode == RightOnly)
+			m_right.end();
+	}
+
+private:
+	enum Mode { Both, LeftOnly, RightOnly, Empty };
+
+	static bool isEmptyBox(pixman_box32_t const &box)
+	{
+		return box.x1 >= box.x2 || box.y1 >= box.y2;
+	}
+
+	static bool boxesOverlap(pixman_box32_t const &a,
+			pixman_box32_t const &b)
+	{
+		return a.x1 < b.x2 && b.x1 < a.x2 &&
+			a.y1 < b.y2 && b.y1 < a.y2;
+	}
+
+	static PixmanRegion const &emptyRegion()
+	{
+		static PixmanRegion const empty;
+		return empty;
+	}
+
+	// which operands the result depends on, judging by their extents
+	static Mode mode(pixman_box32_t const &l, pixman_box32_t const &r)
+	{
+		bool overlap = boxesOverlap(l, r);
+
+		if (Op == RegionExprIntersect)
+			return overlap ? Both : Empty;
+		if (isEmptyBox(l))
+			return (Op == RegionExprSubtract || isEmptyBox(r)) ?
+					Empty : RightOnly;
+		if (!overlap)
+			return isEmptyBox(r) || Op == RegionExprSubtract ?
+					LeftOnly : Both;
+		return Both;
+	}
+
+	Left m_left;
+	Right m_right;
+	PixmanRegionLeaf m_empty;
+	mutable Mode m_mode;
+	mutable pixman_region32_band_op_t m_op;
+};
+
+// maps the operand types of the region operators to expression nodes
+template <class T> struct RegionOperand;
+
+template <> struct RegionOperand<PixmanRegion> {
+	typedef PixmanRegionLeaf type;
+};
+
+template <int Op, class Left, class Right>
+struct RegionOperand< RegionExpr<Op, Left, Right> > {
+	typedef RegionExpr<Op, Left, Right> type;
+};
+
+template <class A, class B>
+RegionExpr<RegionExprUnion, typename RegionOperand<A>::type,
+		typename RegionOperand<B>::type>
+operator|(A const &a, B const &b)
+{
+	return RegionExpr<RegionExprUnion, typename RegionOperand<A>::type,
+			typename RegionOperand<B>::type>(a, b);
+}
+
+template <class A, class B>
+RegionExpr<RegionExprIntersect, typename RegionOperand<A>::type,
+		typename RegionOperand<B>::type>
+operator&(A const &a, B const &b)
+{
+	return RegionExpr<RegionExprIntersect, typename RegionOperand<A>::type,
+			typename RegionOperand<B>::type>(a, b);
+}
+
+template <class A, class B>
+RegionExpr<RegionExprSubtract, typename RegionOperand<A>::type,
+		typename RegionOperand<B>::type>
+operator-(A const &a, B const &b)
+{
+	return RegionExpr<RegionExprSubtract, typename RegionOperand<A>::type,
+			typename RegionOperand<B>::type>(a, b);
+}
+
+template <class A, class B>
+RegionExpr<RegionExprXor, typename RegionOperand<A>::type,
+		typename RegionOperand<B>::type>
+operator^(A const &a, B const &b)
+{
+	return RegionExpr<RegionExprXor, typename RegionOperand<A>::type,
+			typename RegionOperand<B>::type>(a, b);
+}
+
+
 #ifdef PIMAN_REGION_TEST_MAIN
 #include <cassert>
 void main()
@@ -111,6 +111,8 @@ typedef unsigned __int64 uint64_t;
 
 #endif
 
+#include <stddef.h>
+
 /*
  * Boolean
  */
@@ -388,6 +390,16 @@ typedef enum
 
 /*
  * Regions
+ *
+ * Region functions keep no shared mutable state: any of them may be
+ * called concurrently from several threads, as long as no region is
+ * written by one thread while another thread reads or writes it.
+ *
+ * pixman_region_copy() is O(1): the copy shares the source's rectangles
+ * (with an atomic reference count, so the two regions may live on
+ * different threads) until one of them is modified.  For that reason
+ * the array returned by pixman_region_rectangles() must be treated as
+ * read-only.
  */
 typedef struct pixman_region16_data	pixman_region16_data_t;
 typedef struct pixman_box16		pixman_box16_t;
@@ -417,6 +429,91 @@ struct pixman_region16
     pixman_region16_data_t *data;
 };
 
+/* One run of pixels from (x1, y) to (x2, y + 1), as produced by the span
+ * iterator.  The iterator's fields are private; it walks the region's
+ * rectangles in place, so the region must not change while it is used.
+ */
+typedef struct pixman_region16_span		pixman_region16_span_t;
+typedef struct pixman_region16_span_iter	pixman_region16_span_iter_t;
+
+struct pixman_region16_span
+{
+    int16_t y, x1, x2;
+};
+
+struct pixman_region16_span_iter
+{
+    pixman_box16_t *band;
+    pixman_box16_t *box;
+    pixman_box16_t *end;
+    int             y;
+};
+
+/* A band of a flat region: its y range and where its boxes are */
+typedef struct pixman_region_flat_band	pixman_region_flat_band_t;
+
+struct pixman_region_flat_band
+{
+    int32_t  y1, y2;
+    uint32_t first, n_boxes;
+};
+
+/* A region laid out in one block of memory, for use in place (from a
+ * memory mapped file, for example): this header, then n_bands
+ * pixman_region_flat_band_t, then n_rects boxes.  Everything is in
+ * native byte order and needs 4 byte alignment.
+ */
+typedef struct pixman_region16_flat	pixman_region16_flat_t;
+
+struct pixman_region16_flat
+{
+    uint32_t        magic;
+    uint32_t        n_rects;
+    uint32_t        n_bands;
+    uint32_t        reserved;
+    pixman_box16_t  extents;
+};
+
+/* Pull based band iterators, for chaining region operations without
+ * building the intermediate regions.  next () returns the next band:
+ * n_boxes boxes, at least one, sharing y1 and y2 and sorted by x, valid
+ * until the next call.  It returns FALSE at the end, and also on error,
+ * which sets error.  The other structures are private but may be
+ * allocated by the caller, for example on the stack.
+ */
+typedef struct pixman_region16_band_iter	pixman_region16_band_iter_t;
+typedef struct pixman_region16_band_source	pixman_region16_band_source_t;
+typedef struct pixman_region16_band_op	pixman_region16_band_op_t;
+
+struct pixman_region16_band_iter
+{
+    pixman_bool_t	(* next) (pixman_region16_band_iter_t *iter,
+				  const pixman_box16_t       **boxes,
+				  int                         *n_boxes);
+    pixman_bool_t	error;
+};
+
+struct pixman_region16_band_source
+{
+    pixman_region16_band_iter_t  iter;
+    const pixman_box16_t        *box;
+    const pixman_box16_t        *end;
+};
+
+struct pixman_region16_band_op
+{
+    pixman_region16_band_iter_t  iter;
+    pixman_region16_band_iter_t *src1;
+    pixman_region16_band_iter_t *src2;
+    int                          op;
+    const pixman_box16_t        *band1;
+    const pixman_box16_t        *band2;
+    int                          n1, n2;
+    int                          ybot;
+    int                          pending;
+    pixman_region16_t            bands[2];
+};
+
 typedef enum
 {
     PIXMAN_REGION_OUT,
@@ -424,8 +521,37 @@ typedef enum
     PIXMAN_REGION_PART
 } pixman_region_overlap_t;
 
+/*
+ * Parallel region operations
+ *
+ * Pixman never creates threads of its own.  The *_parallel functions
+ * split their work into independent tasks and hand them to the
+ * caller's executor, whose run function must call task (task_data, i)
+ * exactly once for every i in [0, n_tasks), on whatever threads it
+ * likes, and return only when all of them have finished.  Tasks never
+ * call back into the executor.  With a NULL executor, or inputs smaller
+ * than min_rects, the operation simply runs on the calling thread.
+ */
+typedef void (* pixman_region_task_t) (void *task_data, int task_index);
+
+typedef struct pixman_region_executor pixman_region_executor_t;
+
+struct pixman_region_executor
+{
+    void	(* run) (pixman_region_executor_t *executor,
+			 pixman_region_task_t      task,
+			 void                     *task_data,
+			 int                       n_tasks);
+    int		n_threads;	/* number of tasks to split work into */
+    int		min_rects;	/* smaller inputs are processed serially */
+    void *	data;		/* for use by the executor */
+};
+
 /* This function exists only to make it possible to preserve
  * the X ABI - it should go away at first opportunity.
+ *
+ * It may be called at most once, before any 16 bit region is used;
+ * later calls are ignored.
  */
 void pixman_region_set_static_pointers (pixman_box16_t         *empty_box,
 					pixman_region16_data_t *empty_data,
@@ -466,6 +592,10 @@ pixman_bool_t           pixman_region_union_rect         (pixman_region16_t *des
 							  int                y,
 							  unsigned int       width,
 							  unsigned int       height);
+pixman_bool_t           pixman_region_union_rects        (pixman_region16_t    *dest,
+							  pixman_region16_t    *source,
+							  const pixman_box16_t *boxes,
+							  int                   count);
 pixman_bool_t		pixman_region_intersect_rect     (pixman_region16_t *dest,
 							  pixman_region16_t *source,
 							  int                x,
@@ -475,6 +605,15 @@ pixman_bool_t		pixman_region_intersect_rect     (pixman_region16_t *dest,
 pixman_bool_t           pixman_region_subtract           (pixman_region16_t *reg_d,
 							  pixman_region16_t *reg_m,
 							  pixman_region16_t *reg_s);
+pixman_bool_t           pixman_region_subtract_rect      (pixman_region16_t *dest,
+							  pixman_region16_t *source,
+							  int                x,
+							  int                y,
+							  unsigned int       width,
+							  unsigned int       height);
+pixman_bool_t           pixman_region_xor                (pixman_region16_t *new_reg,
+							  pixman_region16_t *reg1,
+							  pixman_region16_t *reg2);
 pixman_bool_t           pixman_region_inverse            (pixman_region16_t *new_reg,
 							  pixman_region16_t *reg1,
 							  pixman_box16_t    *inv_rect);
@@ -491,10 +630,96 @@ pixman_box16_t *        pixman_region_rectangles         (pixman_region16_t *reg
 							  int               *n_rects);
 pixman_bool_t           pixman_region_equal              (pixman_region16_t *region1,
 							  pixman_region16_t *region2);
+uint64_t                pixman_region_area               (pixman_region16_t *region);
+double                  pixman_region_coverage_ratio     (pixman_region16_t *region,
+							  pixman_box16_t    *box);
+pixman_bool_t           pixman_region_simplify           (pixman_region16_t *dst,
+							  pixman_region16_t *src,
+							  int                max_boxes,
+							  uint64_t           max_extra_area);
+uint64_t                pixman_region_hash               (pixman_region16_t *region);
 pixman_bool_t           pixman_region_selfcheck          (pixman_region16_t *region);
 void                    pixman_region_reset              (pixman_region16_t *region,
 							  pixman_box16_t    *box);
 void			pixman_region_clear		 (pixman_region16_t *region);
+
+/* parallel operations */
+pixman_bool_t           pixman_region_union_parallel     (pixman_region16_t        *new_reg,
+							  pixman_region16_t        *reg1,
+							  pixman_region16_t        *reg2,
+							  pixman_region_executor_t *executor);
+pixman_bool_t           pixman_region_intersect_parallel (pixman_region16_t        *new_reg,
+							  pixman_region16_t        *reg1,
+							  pixman_region16_t        *reg2,
+							  pixman_region_executor_t *executor);
+pixman_bool_t           pixman_region_subtract_parallel  (pixman_region16_t        *reg_d,
+							  pixman_region16_t        *reg_m,
+							  pixman_region16_t        *reg_s,
+							  pixman_region_executor_t *executor);
+pixman_bool_t           pixman_region_union_many         (pixman_region16_t        *new_reg,
+							  pixman_region16_t        *regions,
+							  int                       n_regions,
+							  pixman_region_executor_t *executor);
+pixman_bool_t           pixman_region_init_rects_parallel (pixman_region16_t        *region,
+							   const pixman_box16_t     *boxes,
+							   int                       count,
+							   pixman_region_executor_t *executor);
+
+/* scanline spans */
+void                    pixman_region_span_iter_init     (pixman_region16_span_iter_t  *iter,
+							  pixman_region16_t            *region);
+pixman_bool_t           pixman_region_span_iter_next     (pixman_region16_span_iter_t  *iter,
+							  pixman_region16_span_t       *span);
+int                     pixman_region_span_iter_fill     (pixman_region16_span_iter_t  *iter,
+							  pixman_region16_span_t       *spans,
+							  int                           n_spans);
+uint64_t                pixman_region_n_spans            (pixman_region16_t            *region);
+pixman_bool_t           pixman_region_init_spans         (pixman_region16_t            *region,
+							  const pixman_region16_span_t *spans,
+							  int                           count);
+
+/* serialization */
+size_t                  pixman_region_serialize          (pixman_region16_t *region,
+							  uint8_t           *buffer,
+							  size_t             size);
+size_t                  pixman_region_deserialize        (pixman_region16_t *region,
+							  const uint8_t     *buffer,
+							  size_t             size);
+
+/* flat regions */
+size_t                  pixman_region_flat_size          (pixman_region16_t            *region);
+size_t                  pixman_region_flat_write         (pixman_region16_t            *region,
+							  void                         *buffer,
+							  size_t                        size);
+const pixman_region16_flat_t *pixman_region_flat_open   (const void                   *data,
+							  size_t                        size);
+pixman_bool_t           pixman_region_flat_contains_point (const pixman_region16_flat_t *flat,
+							   int                           x,
+							   int                           y,
+							   pixman_box16_t               *box);
+pixman_region_overlap_t pixman_region_flat_contains_rectangle (const pixman_region16_flat_t *flat,
+							       pixman_box16_t               *prect);
+pixman_bool_t           pixman_region_init_flat          (pixman_region16_t            *region,
+							  const pixman_region16_flat_t *flat);
+
+/* band iterators */
+pixman_region16_band_iter_t *pixman_region_band_source_init (pixman_region16_band_source_t *source,
+							     pixman_region16_t             *region);
+pixman_region16_band_iter_t *pixman_region_band_union_init  (pixman_region16_band_op_t     *op,
+							     pixman_region16_band_iter_t   *src1,
+							     pixman_region16_band_iter_t   *src2);
+pixman_region16_band_iter_t *pixman_region_band_intersect_init (pixman_region16_band_op_t  *op,
+								pixman_region16_band_iter_t *src1,
+								pixman_region16_band_iter_t *src2);
+pixman_region16_band_iter_t *pixman_region_band_subtract_init (pixman_region16_band_op_t   *op,
+							       pixman_region16_band_iter_t *src1,
+							       pixman_region16_band_iter_t *src2);
+pixman_region16_band_iter_t *pixman_region_band_xor_init      (pixman_region16_band_op_t   *op,
+							       pixman_region16_band_iter_t *src1,
+							       pixman_region16_band_iter_t *src2);
+void                    pixman_region_band_op_fini       (pixman_region16_band_op_t     *op);
+pixman_bool_t           pixman_region_init_bands         (pixman_region16_t             *region,
+							  pixman_region16_band_iter_t   *iter);
 /*
  * 32 bit regions
  */
@@ -526,6 +751,82 @@ struct pixman_region32
     pixman_region32_data_t  *data;
 };
 
+/* One run of pixels from (x1, y) to (x2, y + 1), as produced by the span
+ * iterator.  The iterator's fields are private; it walks the region's
+ * rectangles in place, so the region must not change while it is used.
+ */
+typedef struct pixman_region32_span		pixman_region32_span_t;
+typedef struct pixman_region32_span_iter	pixman_region32_span_iter_t;
+
+struct pixman_region32_span
+{
+    int32_t y, x1, x2;
+};
+
+struct pixman_region32_span_iter
+{
+    pixman_box32_t *band;
+    pixman_box32_t *box;
+    pixman_box32_t *end;
+    int             y;
+};
+
+/* A region laid out in one block of memory, for use in place (from a
+ * memory mapped file, for example): this header, then n_bands
+ * pixman_region_flat_band_t, then n_rects boxes.  Everything is in
+ * native byte order and needs 4 byte alignment.
+ */
+typedef struct pixman_region32_flat	pixman_region32_flat_t;
+
+struct pixman_region32_flat
+{
+    uint32_t        magic;
+    uint32_t        n_rects;
+    uint32_t        n_bands;
+    uint32_t        reserved;
+    pixman_box32_t  extents;
+};
+
+/* Pull based band iterators, for chaining region operations without
+ * building the intermediate regions.  next () returns the next band:
+ * n_boxes boxes, at least one, sharing y1 and y2 and sorted by x, valid
+ * until the next call.  It returns FALSE at the end, and also on error,
+ * which sets error.  The other structures are private but may be
+ * allocated by the caller, for example on the stack.
+ */
+typedef struct pixman_region32_band_iter	pixman_region32_band_iter_t;
+typedef struct pixman_region32_band_source	pixman_region32_band_source_t;
+typedef struct pixman_region32_band_op	pixman_region32_band_op_t;
+
+struct pixman_region32_band_iter
+{
+    pixman_bool_t	(* next) (pixman_region32_band_iter_t *iter,
+				  const pixman_box32_t       **boxes,
+				  int                         *n_boxes);
+    pixman_bool_t	error;
+};
+
+struct pixman_region32_band_source
+{
+    pixman_region32_band_iter_t  iter;
+    const pixman_box32_t        *box;
+    const pixman_box32_t        *end;
+};
+
+struct pixman_region32_band_op
+{
+    pixman_region32_band_iter_t  iter;
+    pixman_region32_band_iter_t *src1;
+    pixman_region32_band_iter_t *src2;
+    int                          op;
+    const pixman_box32_t        *band1;
+    const pixman_box32_t        *band2;
+    int                          n1, n2;
+    int                          ybot;
+    int                          pending;
+    pixman_region32_t            bands[2];
+};
+
 /* creation/destruction */
 void                    pixman_region32_init               (pixman_region32_t *region);
 void                    pixman_region32_init_rect          (pixman_region32_t *region,
@@ -567,9 +868,22 @@ pixman_bool_t           pixman_region32_union_rect         (pixman_region32_t *d
 							    int                y,
 							    unsigned int       width,
 							    unsigned int       height);
+pixman_bool_t           pixman_region32_union_rects        (pixman_region32_t    *dest,
+							    pixman_region32_t    *source,
+							    const pixman_box32_t *boxes,
+							    int                   count);
 pixman_bool_t           pixman_region32_subtract           (pixman_region32_t *reg_d,
 							    pixman_region32_t *reg_m,
 							    pixman_region32_t *reg_s);
+pixman_bool_t           pixman_region32_subtract_rect      (pixman_region32_t *dest,
+							    pixman_region32_t *source,
+							    int                x,
+							    int                y,
+							    unsigned int       width,
+							    unsigned int       height);
+pixman_bool_t           pixman_region32_xor                (pixman_region32_t *new_reg,
+							    pixman_region32_t *reg1,
+							    pixman_region32_t *reg2);
 pixman_bool_t           pixman_region32_inverse            (pixman_region32_t *new_reg,
 							    pixman_region32_t *reg1,
 							    pixman_box32_t    *inv_rect);
@@ -586,11 +900,422 @@ pixman_box32_t *        pixman_region32_rectangles         (pixman_region32_t *r
 							    int               *n_rects);
 pixman_bool_t           pixman_region32_equal              (pixman_region32_t *region1,
 							    pixman_region32_t *region2);
+uint64_t                pixman_region32_area               (pixman_region32_t *region);
+double                  pixman_region32_coverage_ratio     (pixman_region32_t *region,
+							    pixman_box32_t    *box);
+pixman_bool_t           pixman_region32_simplify           (pixman_region32_t *dst,
+							    pixman_region32_t *src,
+							    int                max_boxes,
+							    uint64_t           max_extra_area);
+uint64_t                pixman_region32_hash               (pixman_region32_t *region);
 pixman_bool_t           pixman_region32_selfcheck          (pixman_region32_t *region);
 void                    pixman_region32_reset              (pixman_region32_t *region,
 							    pixman_box32_t    *box);
 void			pixman_region32_clear		   (pixman_region32_t *region);
 
+/* parallel operations */
+pixman_bool_t           pixman_region32_union_parallel     (pixman_region32_t        *new_reg,
+							    pixman_region32_t        *reg1,
+							    pixman_region32_t        *reg2,
+							    pixman_region_executor_t *executor);
+pixman_bool_t           pixman_region32_intersect_parallel (pixman_region32_t        *new_reg,
+							    pixman_region32_t        *reg1,
+							    pixman_region32_t        *reg2,
+							    pixman_region_executor_t *executor);
+pixman_bool_t           pixman_region32_subtract_parallel  (pixman_region32_t        *reg_d,
+							    pixman_region32_t        *reg_m,
+							    pixman_region32_t        *reg_s,
+							    pixman_region_executor_t *executor);
+pixman_bool_t           pixman_region32_union_many         (pixman_region32_t        *new_reg,
+							    pixman_region32_t        *regions,
+							    int                       n_regions,
+							    pixman_region_executor_t *executor);
+pixman_bool_t           pixman_region32_init_rects_parallel (pixman_region32_t        *region,
+							     const pixman_box32_t     *boxes,
+							     int                       count,
+							     pixman_region_executor_t *executor);
+
+/* scanline spans */
+void                    pixman_region32_span_iter_init     (pixman_region32_span_iter_t  *iter,
+							    pixman_region32_t            *region);
+pixman_bool_t           pixman_region32_span_iter_next     (pixman_region32_span_iter_t  *iter,
+							    pixman_region32_span_t       *span);
+int                     pixman_region32_span_iter_fill     (pixman_region32_span_iter_t  *iter,
+							    pixman_region32_span_t       *spans,
+							    int                           n_spans);
+uint64_t                pixman_region32_n_spans            (pixman_region32_t            *region);
+pixman_bool_t           pixman_region32_init_spans         (pixman_region32_t            *region,
+							    const pixman_region32_span_t *spans,
+							    int                           count);
+
+/* serialization */
+size_t                  pixman_region32_serialize          (pixman_region32_t *region,
+							    uint8_t           *buffer,
+							    size_t             size);
+size_t                  pixman_region32_deserialize        (pixman_region32_t *region,
+							    const uint8_t     *buffer,
+							    size_t             size);
+
+/* flat regions */
+size_t                  pixman_region32_flat_size          (pixman_region32_t            *region);
+size_t                  pixman_region32_flat_write         (pixman_region32_t            *region,
+							    void                         *buffer,
+							    size_t                        size);
+const pixman_region32_flat_t *pixman_region32_flat_open   (const void                   *data,
+							    size_t                        size);
+pixman_bool_t           pixman_region32_flat_contains_point (const pixman_region32_flat_t *flat,
+							     int                           x,
+							     int                           y,
+							     pixman_box32_t               *box);
+pixman_region_overlap_t pixman_region32_flat_contains_rectangle (const pixman_region32_flat_t *flat,
+								 pixman_box32_t               *prect);
+pixman_bool_t           pixman_region32_init_flat          (pixman_region32_t            *region,
+							    const pixman_region32_flat_t *flat);
+
+/* band iterators */
+pixman_region32_band_iter_t *pixman_region32_band_source_init (pixman_region32_band_source_t *source,
+							       pixman_region32_t             *region);
+pixman_region32_band_iter_t *pixman_region32_band_union_init  (pixman_region32_band_op_t     *op,
+							       pixman_region32_band_iter_t   *src1,
+							       pixman_region32_band_iter_t   *src2);
+pixman_region32_band_iter_t *pixman_region32_band_intersect_init (pixman_region32_band_op_t  *op,
+								  pixman_region32_band_iter_t *src1,
+								  pixman_region32_band_iter_t *src2);
+pixman_region32_band_iter_t *pixman_region32_band_subtract_init (pixman_region32_band_op_t   *op,
+								 pixman_region32_band_iter_t *src1,
+								 pixman_region32_band_iter_t *src2);
+pixman_region32_band_iter_t *pixman_region32_band_xor_init      (pixman_region32_band_op_t   *op,
+								 pixman_region32_band_iter_t *src1,
+								 pixman_region32_band_iter_t *src2);
+void                    pixman_region32_band_op_fini       (pixman_region32_band_op_t     *op);
+pixman_bool_t           pixman_region32_init_bands         (pixman_region32_t             *region,
+							    pixman_region32_band_iter_t   *iter);
+
+/*
+ * 64 bit regions, for coordinates beyond the 32 bit range.  They need a
+ * compiler with a 128 bit integer type (__int128), which they compute
+ * with to avoid overflow, and are not built elsewhere.  The area and
+ * simplification functions assume that areas fit in 64 bits.
+ */
+typedef struct pixman_region64_data	pixman_region64_data_t;
+typedef struct pixman_box64		pixman_box64_t;
+typedef struct pixman_region64		pixman_region64_t;
+
+struct pixman_region64_data {
+    long		size;
+    long		numRects;
+/*  pixman_box64_t	rects[size];   in memory but not explicitly declared */
+};
+
+struct pixman_box64
+{
+    int64_t x1, y1, x2, y2;
+};
+
+struct pixman_region64
+{
+    pixman_box64_t          extents;
+    pixman_region64_data_t  *data;
+};
+
+/* One run of pixels from (x1, y) to (x2, y + 1), as produced by the span
+ * iterator.  The iterator's fields are private; it walks the region's
+ * rectangles in place, so the region must not change while it is used.
+ */
+typedef struct pixman_region64_span		pixman_region64_span_t;
+typedef struct pixman_region64_span_iter	pixman_region64_span_iter_t;
+
+struct pixman_region64_span
+{
+    int64_t y, x1, x2;
+};
+
+struct pixman_region64_span_iter
+{
+    pixman_box64_t *band;
+    pixman_box64_t *box;
+    pixman_box64_t *end;
+    int64_t         y;
+};
+
+/* A region laid out in one block of memory, for use in place (from a
+ * memory mapped file, for example): this header, then n_bands
+ * pixman_region64_flat_band_t, then n_rects boxes.  Everything is in
+ * native byte order and needs 8 byte alignment.
+ */
+typedef struct pixman_region64_flat_band	pixman_region64_flat_band_t;
+typedef struct pixman_region64_flat	pixman_region64_flat_t;
+
+struct pixman_region64_flat_band
+{
+    int64_t  y1, y2;
+    uint32_t first;
+    uint32_t n_boxes;
+};
+
+struct pixman_region64_flat
+{
+    uint32_t        magic;
+    uint32_t        n_rects;
+    uint32_t        n_bands;
+    uint32_t        reserved;
+    pixman_box64_t  extents;
+};
+
+/* Pull based band iterators, for chaining region operations without
+ * building the intermediate regions.  next () returns the next band:
+ * n_boxes boxes, at least one, sharing y1 and y2 and sorted by x, valid
+ * until the next call.  It returns FALSE at the end, and also on error,
+ * which sets error.  The other structures are private but may be
+ * allocated by the caller, for example on the stack.
+ */
+typedef struct pixman_region64_band_iter	pixman_region64_band_iter_t;
+typedef struct pixman_region64_band_source	pixman_region64_band_source_t;
+typedef struct pixman_region64_band_op	pixman_region64_band_op_t;
+
+struct pixman_region64_band_iter
+{
+    pixman_bool_t	(* next) (pixman_region64_band_iter_t *iter,
+				  const pixman_box64_t       **boxes,
+				  int                         *n_boxes);
+    pixman_bool_t	error;
+};
+
+struct pixman_region64_band_source
+{
+    pixman_region64_band_iter_t  iter;
+    const pixman_box64_t        *box;
+    const pixman_box64_t        *end;
+};
+
+struct pixman_region64_band_op
+{
+    pixman_region64_band_iter_t  iter;
+    pixman_region64_band_iter_t *src1;
+    pixman_region64_band_iter_t *src2;
+    int                          op;
+    const pixman_box64_t        *band1;
+    const pixman_box64_t        *band2;
+    int                          n1, n2;
+    int64_t                      ybot;
+    int                          pending;
+    pixman_region64_t            bands[2];
+};
+
+/* creation/destruction */
+void                    pixman_region64_init               (pixman_region64_t *region);
+void                    pixman_region64_init_rect          (pixman_region64_t *region,
+							    int64_t            x,
+							    int64_t            y,
+							    uint64_t           width,
+							    uint64_t           height);
+pixman_bool_t           pixman_region64_init_rects         (pixman_region64_t *region,
+							    const pixman_box64_t *boxes,
+							    int                count);
+void                    pixman_region64_init_with_extents  (pixman_region64_t *region,
+							    pixman_box64_t    *extents);
+void                    pixman_region64_fini               (pixman_region64_t *region);
+
+
+/* manipulation */
+void                    pixman_region64_translate          (pixman_region64_t *region,
+							    int64_t            x,
+							    int64_t            y);
+pixman_bool_t           pixman_region64_copy               (pixman_region64_t *dest,
+							    pixman_region64_t *source);
+pixman_bool_t           pixman_region64_intersect          (pixman_region64_t *new_reg,
+							    pixman_region64_t *reg1,
+							    pixman_region64_t *reg2);
+pixman_bool_t           pixman_region64_union              (pixman_region64_t *new_reg,
+							    pixman_region64_t *reg1,
+							    pixman_region64_t *reg2);
+pixman_bool_t		pixman_region64_intersect_rect     (pixman_region64_t *dest,
+							    pixman_region64_t *source,
+							    int64_t            x,
+							    int64_t            y,
+							    uint64_t           width,
+							    uint64_t           height);
+pixman_bool_t           pixman_region64_union_rect         (pixman_region64_t *dest,
+							    pixman_region64_t *source,
+							    int64_t            x,
+							    int64_t            y,
+							    uint64_t           width,
+							    uint64_t           height);
+pixman_bool_t           pixman_region64_union_rects        (pixman_region64_t    *dest,
+							    pixman_region64_t    *source,
+							    const pixman_box64_t *boxes,
+							    int                   count);
+pixman_bool_t           pixman_region64_subtract           (pixman_region64_t *reg_d,
+							    pixman_region64_t *reg_m,
+							    pixman_region64_t *reg_s);
+pixman_bool_t           pixman_region64_subtract_rect      (pixman_region64_t *dest,
+							    pixman_region64_t *source,
+							    int64_t            x,
+							    int64_t            y,
+							    uint64_t           width,
+							    uint64_t           height);
+pixman_bool_t           pixman_region64_xor                (pixman_region64_t *new_reg,
+							    pixman_region64_t *reg1,
+							    pixman_region64_t *reg2);
+pixman_bool_t           pixman_region64_inverse            (pixman_region64_t *new_reg,
+							    pixman_region64_t *reg1,
+							    pixman_box64_t    *inv_rect);
+pixman_bool_t           pixman_region64_contains_point     (pixman_region64_t *region,
+							    int64_t            x,
+							    int64_t            y,
+							    pixman_box64_t    *box);
+pixman_region_overlap_t pixman_region64_contains_rectangle (pixman_region64_t *region,
+							    pixman_box64_t    *prect);
+pixman_bool_t           pixman_region64_not_empty          (pixman_region64_t *region);
+pixman_box64_t *        pixman_region64_extents            (pixman_region64_t *region);
+int                     pixman_region64_n_rects            (pixman_region64_t *region);
+pixman_box64_t *        pixman_region64_rectangles         (pixman_region64_t *region,
+							    int               *n_rects);
+pixman_bool_t           pixman_region64_equal              (pixman_region64_t *region1,
+							    pixman_region64_t *region2);
+uint64_t                pixman_region64_area               (pixman_region64_t *region);
+double                  pixman_region64_coverage_ratio     (pixman_region64_t *region,
+							    pixman_box64_t    *box);
+pixman_bool_t           pixman_region64_simplify           (pixman_region64_t *dst,
+							    pixman_region64_t *src,
+							    int                max_boxes,
+							    uint64_t           max_extra_area);
+uint64_t                pixman_region64_hash               (pixman_region64_t *region);
+pixman_bool_t           pixman_region64_selfcheck          (pixman_region64_t *region);
+void                    pixman_region64_reset              (pixman_region64_t *region,
+							    pixman_box64_t    *box);
+void			pixman_region64_clear		   (pixman_region64_t *region);
+
+/* parallel operations */
+pixman_bool_t           pixman_region64_union_parallel     (pixman_region64_t        *new_reg,
+							    pixman_region64_t        *reg1,
+							    pixman_region64_t        *reg2,
+							    pixman_region_executor_t *executor);
+pixman_bool_t           pixman_region64_intersect_parallel (pixman_region64_t        *new_reg,
+							    pixman_region64_t        *reg1,
+							    pixman_region64_t        *reg2,
+							    pixman_region_executor_t *executor);
+pixman_bool_t           pixman_region64_subtract_parallel  (pixman_region64_t        *reg_d,
+							    pixman_region64_t        *reg_m,
+							    pixman_region64_t        *reg_s,
+							    pixman_region_executor_t *executor);
+pixman_bool_t           pixman_region64_union_many         (pixman_region64_t        *new_reg,
+							    pixman_region64_t        *regions,
+							    int                       n_regions,
+							    pixman_region_executor_t *executor);
+pixman_bool_t           pixman_region64_init_rects_parallel (pixman_region64_t        *region,
+							     const pixman_box64_t     *boxes,
+							     int                       count,
+							     pixman_region_executor_t *executor);
+
+/* scanline spans */
+void                    pixman_region64_span_iter_init     (pixman_region64_span_iter_t  *iter,
+							    pixman_region64_t            *region);
+pixman_bool_t           pixman_region64_span_iter_next     (pixman_region64_span_iter_t  *iter,
+							    pixman_region64_span_t       *span);
+int                     pixman_region64_span_iter_fill     (pixman_region64_span_iter_t  *iter,
+							    pixman_region64_span_t       *spans,
+							    int                           n_spans);
+uint64_t                pixman_region64_n_spans            (pixman_region64_t            *region);
+pixman_bool_t           pixman_region64_init_spans         (pixman_region64_t            *region,
+							    const pixman_region64_span_t *spans,
+							    int                           count);
+
+/* serialization */
+size_t                  pixman_region64_serialize          (pixman_region64_t *region,
+							    uint8_t           *buffer,
+							    size_t             size);
+size_t                  pixman_region64_deserialize        (pixman_region64_t *region,
+							    const uint8_t     *buffer,
+							    size_t             size);
+
+/* flat regions */
+size_t                  pixman_region64_flat_size          (pixman_region64_t            *region);
+size_t                  pixman_region64_flat_write         (pixman_region64_t            *region,
+							    void                         *buffer,
+							    size_t                        size);
+const pixman_region64_flat_t *pixman_region64_flat_open   (const void                   *data,
+							    size_t                        size);
+pixman_bool_t           pixman_region64_flat_contains_point (const pixman_region64_flat_t *flat,
+							     int64_t                       x,
+							     int64_t                       y,
+							     pixman_box64_t               *box);
+pixman_region_overlap_t pixman_region64_flat_contains_rectangle (const pixman_region64_flat_t *flat,
+								 pixman_box64_t               *prect);
+pixman_bool_t           pixman_region64_init_flat          (pixman_region64_t            *region,
+							    const pixman_region64_flat_t *flat);
+
+/* band iterators */
+pixman_region64_band_iter_t *pixman_region64_band_source_init (pixman_region64_band_source_t *source,
+							       pixman_region64_t             *region);
+pixman_region64_band_iter_t *pixman_region64_band_union_init  (pixman_region64_band_op_t     *op,
+							       pixman_region64_band_iter_t   *src1,
+							       pixman_region64_band_iter_t   *src2);
+pixman_region64_band_iter_t *pixman_region64_band_intersect_init (pixman_region64_band_op_t  *op,
+								  pixman_region64_band_iter_t *src1,
+								  pixman_region64_band_iter_t *src2);
+pixman_region64_band_iter_t *pixman_region64_band_subtract_init (pixman_region64_band_op_t   *op,
+								 pixman_region64_band_iter_t *src1,
+								 pixman_region64_band_iter_t *src2);
+pixman_region64_band_iter_t *pixman_region64_band_xor_init      (pixman_region64_band_op_t   *op,
+								 pixman_region64_band_iter_t *src1,
+								 pixman_region64_band_iter_t *src2);
+void                    pixman_region64_band_op_fini       (pixman_region64_band_op_t     *op);
+pixman_bool_t           pixman_region64_init_bands         (pixman_region64_t             *region,
+							    pixman_region64_band_iter_t   *iter);
+
+/* damage history, for buffer age based partial repaint */
+typedef struct pixman_region32_damage pixman_region32_damage_t;
+
+pixman_region32_damage_t *pixman_region32_damage_create    (int                       max_age);
+void                    pixman_region32_damage_destroy     (pixman_region32_damage_t *damage);
+void                    pixman_region32_damage_reset       (pixman_region32_damage_t *damage);
+pixman_bool_t           pixman_region32_damage_add_frame   (pixman_region32_damage_t *damage,
+							    pixman_region32_t        *frame_damage);
+pixman_bool_t           pixman_region32_damage_since       (pixman_region32_damage_t *damage,
+							    int                       age,
+							    pixman_region32_t        *result);
+
+/* tiled bitmaps, for very fragmented regions */
+typedef struct pixman_region32_tiles pixman_region32_tiles_t;
+
+pixman_region32_tiles_t *pixman_region32_tiles_create      (void);
+void                    pixman_region32_tiles_destroy      (pixman_region32_tiles_t *tiles);
+pixman_bool_t           pixman_region32_tiles_from_region  (pixman_region32_tiles_t *tiles,
+							    pixman_region32_t       *region);
+pixman_bool_t           pixman_region32_tiles_to_region    (pixman_region32_tiles_t *tiles,
+							    pixman_region32_t       *region);
+pixman_bool_t           pixman_region32_tiles_union        (pixman_region32_tiles_t *dst,
+							    pixman_region32_tiles_t *a,
+							    pixman_region32_tiles_t *b);
+pixman_bool_t           pixman_region32_tiles_intersect    (pixman_region32_tiles_t *dst,
+							    pixman_region32_tiles_t *a,
+							    pixman_region32_tiles_t *b);
+pixman_bool_t           pixman_region32_tiles_subtract     (pixman_region32_tiles_t *dst,
+							    pixman_region32_tiles_t *a,
+							    pixman_region32_tiles_t *b);
+
+/* band tables, a more compact layout for regions with wide bands */
+typedef struct pixman_region32_table pixman_region32_table_t;
+
+pixman_region32_table_t *pixman_region32_table_create      (void);
+void                    pixman_region32_table_destroy      (pixman_region32_table_t *table);
+pixman_bool_t           pixman_region32_table_from_region  (pixman_region32_table_t *table,
+							    pixman_region32_t       *region);
+pixman_bool_t           pixman_region32_table_to_region    (pixman_region32_table_t *table,
+							    pixman_region32_t       *region);
+int                     pixman_region32_table_n_bands      (pixman_region32_table_t *table);
+int                     pixman_region32_table_n_spans      (pixman_region32_table_t *table);
+pixman_bool_t           pixman_region32_table_union        (pixman_region32_table_t *dst,
+							    pixman_region32_table_t *a,
+							    pixman_region32_table_t *b);
+pixman_bool_t           pixman_region32_table_intersect    (pixman_region32_table_t *dst,
+							    pixman_region32_table_t *a,
+							    pixman_region32_table_t *b);
+pixman_bool_t           pixman_region32_table_subtract     (pixman_region32_table_t *dst,
+							    pixman_region32_table_t *a,
+							    pixman_region32_table_t *b);
+
 
 /* Copy / Fill / Misc */
 pixman_bool_t pixman_blt                (uint32_t           *src_bits,
@@ -9,6 +9,8 @@
  *    limits	     limits for various types must be defined
  *    inline         must be defined
  *    force_inline   must be defined
+ *    atomics        int fetch-and-add, compare-and-swap and load, and
+ *                   64 bit load and store must be defined
  */
 #if defined (__GNUC__)
 #  define FUNC     ((const char*) (__PRETTY_FUNCTION__))
@@ -230,3 +232,158 @@
 #    error "Unknown thread local support for this system. Pixman will not work with multiple threads. Define PIXMAN_NO_TLS to acknowledge and accept this limitation and compile pixman without thread-safety support."
 
 #endif
+
+/* Atomics
+ *
+ * The region code keeps no mutable global state on its hot paths; these
+ * are only used for init-once guards, the reference counts of shared
+ * rectangle arrays and the values cached alongside them.
+ */
+#if defined(PIXMAN_NO_ATOMICS)
+
+static force_inline int
+pixman_atomic_fetch_add_int (volatile int *ptr, int value)
+{
+    int old = *ptr;
+    *ptr = old + value;
+    return old;
+}
+
+static force_inline int
+pixman_atomic_cas_int (volatile int *ptr, int expected, int desired)
+{
+    if (*ptr != expected)
+	return 0;
+    *ptr = desired;
+    return 1;
+}
+
+static force_inline int
+pixman_atomic_load_int (volatile int *ptr)
+{
+    return *ptr;
+}
+
+static force_inline uint64_t
+pixman_atomic_load_u64 (volatile uint64_t *ptr)
+{
+    return *ptr;
+}
+
+static force_inline void
+pixman_atomic_store_u64 (volatile uint64_t *ptr, uint64_t value)
+{
+    *ptr = value;
+}
+
+#elif defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+
+static force_inline int
+pixman_atomic_fetch_add_int (volatile int *ptr, int value)
+{
+    return __atomic_fetch_add (ptr, value, __ATOMIC_ACQ_REL);
+}
+
+static force_inline int
+pixman_atomic_cas_int (volatile int *ptr, int expected, int desired)
+{
+    return __atomic_compare_exchange_n (ptr, &expected, desired, 0,
+					__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static force_inline int
+pixman_atomic_load_int (volatile int *ptr)
+{
+    return __atomic_load_n (ptr, __ATOMIC_ACQUIRE);
+}
+
+static force_inline uint64_t
+pixman_atomic_load_u64 (volatile uint64_t *ptr)
+{
+    return __atomic_load_n (ptr, __ATOMIC_RELAXED);
+}
+
+static force_inline void
+pixman_atomic_store_u64 (volatile uint64_t *ptr, uint64_t value)
+{
+    __atomic_store_n (ptr, value, __ATOMIC_RELAXED);
+}
+
+#elif defined(__GNUC__)
+
+static force_inline int
+pixman_atomic_fetch_add_int (volatile int *ptr, int value)
+{
+    return __sync_fetch_and_add (ptr, value);
+}
+
+static force_inline int
+pixman_atomic_cas_int (volatile int *ptr, int expected, int desired)
+{
+    return __sync_bool_compare_and_swap (ptr, expected, desired);
+}
+
+static force_inline int
+pixman_atomic_load_int (volatile int *ptr)
+{
+    return __sync_fetch_and_add (ptr, 0);
+}
+
+static force_inline uint64_t
+pixman_atomic_load_u64 (volatile uint64_t *ptr)
+{
+    return __sync_fetch_and_add (ptr, 0);
+}
+
+static force_inline void
+pixman_atomic_store_u64 (volatile uint64_t *ptr, uint64_t value)
+{
+    uint64_t old;
+
+    do
+    {
+	old = *ptr;
+    }
+    while (!__sync_bool_compare_and_swap (ptr, old, value));
+}
+
+#elif defined(_MSC_VER)
+
+#include <intrin.h>
+
+static force_inline int
+pixman_atomic_fetch_add_int (volatile int *ptr, int value)
+{
+    return _InterlockedExchangeAdd ((volatile long *)ptr, value);
+}
+
+static force_inline int
+pixman_atomic_cas_int (volatile int *ptr, int expected, int desired)
+{
+    return _InterlockedCompareExchange ((volatile long *)ptr,
+					desired, expected) == expected;
+}
+
+static force_inline int
+pixman_atomic_load_int (volatile int *ptr)
+{
+    return _InterlockedCompareExchange ((volatile long *)ptr, 0, 0);
+}
+
+static force_inline uint64_t
+pixman_atomic_load_u64 (volatile uint64_t *ptr)
+{
+    return _InterlockedCompareExchange64 ((volatile __int64 *)ptr, 0, 0);
+}
+
+static force_inline void
+pixman_atomic_store_u64 (volatile uint64_t *ptr, uint64_t value)
+{
+    _InterlockedExchange64 ((volatile __int64 *)ptr, value);
+}
+
+#else
+
+#    error "Unknown atomic operation support for this system. Define PIXMAN_NO_ATOMICS to acknowledge that regions must then not be used from more than one thread."
+
+#endif
@@ -0,0 +1,179 @@
+
+/*
+ * Copyright © 2008 Red Hat, Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * Red Hat, Inc. not be used in advertising or publicity pertaining to
+ * distribution of the software without specific, written prior
+ * permission. Red Hat, Inc. makes no representations about the
+ * suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * RED HAT, INC. DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL RED HAT, INC. BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR
+ * IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Damage history for buffer age based partial repaint.
+ *
+ * With a buffer that was last drawn age frames ago, the area to repaint
+ * is the union of the damage of the last age frames.  Rather than union
+ * up to max_age regions on every query, the history keeps, for every
+ * frame f and every level j with 2^j <= max_age, the union of the 2^j
+ * frames ending at f.  Adding a frame costs log2 (max_age) unions, and
+ * any run of the last age frames is covered by two (possibly
+ * overlapping) blocks of the same level, so a query is at most one
+ * union.  Copies of regions share their rectangles, so the blocks cost
+ * little memory when frames repeat.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "pixman-private.h"
+
+#include <stdlib.h>
+
+struct pixman_region32_damage
+{
+    int                max_age;
+    int                n_levels;
+    int                n_frames;	/* frames added since the last reset */
+    pixman_region32_t *blocks;		/* max_age slots of n_levels regions */
+};
+
+#define BLOCK(damage, frame, level)					\
+    (&(damage)->blocks[((frame) % (damage)->max_age) * (damage)->n_levels + (level)])
+
+PIXMAN_EXPORT pixman_region32_damage_t *
+pixman_region32_damage_create (int max_age)
+{
+    pixman_region32_damage_t *damage;
+    int i;
+
+    if (max_age < 1)
+	return NULL;
+
+    damage = malloc (sizeof (pixman_region32_damage_t));
+    if (!damage)
+	return NULL;
+
+    damage->max_age = max_age;
+    damage->n_levels = 1;
+    damage->n_frames = 0;
+
+    while (damage->n_levels < 31 && (1 << damage->n_levels) <= max_age)
+	damage->n_levels++;
+
+    damage->blocks = pixman_malloc_ab (
+	max_age * damage->n_levels, sizeof (pixman_region32_t));
+
+    if (!damage->blocks)
+    {
+	free (damage);
+	return NULL;
+    }
+
+    for (i = 0; i < max_age * damage->n_levels; i++)
+	pixman_region32_init (&damage->blocks[i]);
+
+    return damage;
+}
+
+PIXMAN_EXPORT void
+pixman_region32_damage_destroy (pixman_region32_damage_t *damage)
+{
+    int i;
+
+    if (!damage)
+	return;
+
+    for (i = 0; i < damage->max_age * damage->n_levels; i++)
+	pixman_region32_fini (&damage->blocks[i]);
+
+    free (damage->blocks);
+    free (damage);
+}
+
+/* Forget all frames, for example when the buffers are reallocated */
+PIXMAN_EXPORT void
+pixman_region32_damage_reset (pixman_region32_damage_t *damage)
+{
+    damage->n_frames = 0;
+}
+
+PIXMAN_EXPORT pixman_bool_t
+pixman_region32_damage_add_frame (pixman_region32_damage_t *damage,
+                                  pixman_region32_t *       frame_damage)
+{
+    int frame = damage->n_frames;
+    int j;
+
+    if (!pixman_region32_copy (BLOCK (damage, frame, 0), frame_damage))
+	goto bail;
+
+    for (j = 1; j < damage->n_levels && frame + 1 >= (1 << j); j++)
+    {
+	if (!pixman_region32_union (BLOCK (damage, frame, j),
+				    BLOCK (damage, frame, j - 1),
+				    BLOCK (damage, frame - (1 << (j - 1)), j - 1)))
+	{
+	    goto bail;
+	}
+    }
+
+    /* Keep the frame counter bounded while staying congruent to the
+     * slot numbering.
+     */
+    damage->n_frames++;
+    if (damage->n_frames >= INT32_MAX / 2)
+	damage->n_frames = damage->n_frames % damage->max_age + damage->max_age;
+
+    return TRUE;
+
+bail:
+    /* The history is incomplete, so nothing can be answered from it */
+    damage->n_frames = 0;
+    return FALSE;
+}
+
+/* Sets result to the union of the damage of the last age frames.  Returns
+ * FALSE if fewer than age frames are known, in which case the caller has
+ * to repaint everything.  An age of 0 gives an empty region.
+ */
+PIXMAN_EXPORT pixman_bool_t
+pixman_region32_damage_since (pixman_region32_damage_t *damage,
+                              int                       age,
+                              pixman_region32_t *       result)
+{
+    int newest = damage->n_frames - 1;
+    int j;
+
+    if (age < 0 || age > damage->max_age || age > damage->n_frames)
+	return FALSE;
+
+    if (age == 0)
+    {
+	pixman_region32_clear (result);
+	return TRUE;
+    }
+
+    for (j = 0; (2 << j) <= age; j++)
+	;
+
+    if ((1 << j) == age)
+	return pixman_region32_copy (result, BLOCK (damage, newest, j));
+
+    return pixman_region32_union (result,
+				  BLOCK (damage, newest, j),
+				  BLOCK (damage, newest - age + (1 << j), j));
+}
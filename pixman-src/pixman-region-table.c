@@ -0,0 +1,599 @@
+
+/*
+ * Copyright © 2008 Red Hat, Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * Red Hat, Inc. not be used in advertising or publicity pertaining to
+ * distribution of the software without specific, written prior
+ * permission. Red Hat, Inc. makes no representations about the
+ * suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * RED HAT, INC. DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL RED HAT, INC. BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR
+ * IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Band table regions.
+ *
+ * A region's boxes come in bands that share y1 and y2, so a box list
+ * stores every band's y range once per box.  A band table stores it once
+ * per band instead: an array of bands { y1, y2, first }, where first is
+ * the index of the band's first x span, and one flat array of x spans
+ * { x1, x2 } for all bands.  A band's spans run up to the next band's
+ * first span, or to the end of the array for the last band.  That is 8
+ * bytes per box and 12 per band rather than 16 per box, so regions with
+ * wide bands take about half the memory.
+ *
+ * The operations sweep the two band arrays like pixman_op() does with
+ * boxes, and combine the x spans of overlapping bands with simple merge
+ * loops over the two span arrays.  The output space for a band is
+ * reserved before the loop, so the loops only read and write spans.
+ * Bands are coalesced as they are added, which keeps the tables in the
+ * same canonical form as the box lists.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "pixman-private.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+    int32_t  y1, y2;
+    uint32_t first;		/* index of the band's first span */
+} band_t;
+
+typedef struct
+{
+    int32_t x1, x2;
+} span_t;
+
+struct pixman_region32_table
+{
+    int     n_bands, bands_size;
+    int     n_spans, spans_size;
+    band_t *bands;
+    span_t *spans;
+};
+
+/* Index one past the last span of band i */
+#define BAND_END(t, i)							\
+    ((i) + 1 < (t)->n_bands ? (int)(t)->bands[(i) + 1].first : (t)->n_spans)
+
+static void
+clear_table (pixman_region32_table_t *t)
+{
+    free (t->bands);
+    free (t->spans);
+
+    t->n_bands = t->bands_size = 0;
+    t->n_spans = t->spans_size = 0;
+    t->bands = NULL;
+    t->spans = NULL;
+}
+
+/* Makes room for n more bands and m more spans */
+static pixman_bool_t
+reserve (pixman_region32_table_t *t, int n, int m)
+{
+    if (t->n_bands + n > t->bands_size)
+    {
+	int size = MAX (t->n_bands + n, 2 * t->bands_size);
+	band_t *bands;
+
+	if (size < 0 || size > INT32_MAX / 2)
+	    return FALSE;
+
+	bands = pixman_malloc_ab (size, sizeof (band_t));
+	if (!bands)
+	    return FALSE;
+
+	if (t->n_bands)
+	    memcpy (bands, t->bands, t->n_bands * sizeof (band_t));
+	free (t->bands);
+
+	t->bands = bands;
+	t->bands_size = size;
+    }
+
+    if (t->n_spans + m > t->spans_size)
+    {
+	int size = MAX (t->n_spans + m, 2 * t->spans_size);
+	span_t *spans;
+
+	if (size < 0 || size > INT32_MAX / 2)
+	    return FALSE;
+
+	spans = pixman_malloc_ab (size, sizeof (span_t));
+	if (!spans)
+	    return FALSE;
+
+	if (t->n_spans)
+	    memcpy (spans, t->spans, t->n_spans * sizeof (span_t));
+	free (t->spans);
+
+	t->spans = spans;
+	t->spans_size = size;
+    }
+
+    return TRUE;
+}
+
+/* Ends a band whose spans were written from index first on.  Empty bands
+ * are dropped, and a band with the same spans as the one right above it
+ * only extends that band downwards.
+ */
+static void
+end_band (pixman_region32_table_t *t, int first, int y1, int y2)
+{
+    int n = t->n_spans - first;
+    band_t *prev;
+
+    if (!n)
+	return;
+
+    if (t->n_bands)
+    {
+	prev = &t->bands[t->n_bands - 1];
+
+	if (prev->y2 == y1 && (int)(first - prev->first) == n &&
+	    memcmp (&t->spans[prev->first], &t->spans[first], n * sizeof (span_t)) == 0)
+	{
+	    prev->y2 = y2;
+	    t->n_spans = first;
+	    return;
+	}
+    }
+
+    prev = &t->bands[t->n_bands++];
+    prev->y1 = y1;
+    prev->y2 = y2;
+    prev->first = first;
+}
+
+PIXMAN_EXPORT pixman_region32_table_t *
+pixman_region32_table_create (void)
+{
+    pixman_region32_table_t *t = malloc (sizeof (pixman_region32_table_t));
+
+    if (t)
+    {
+	t->n_bands = t->bands_size = 0;
+	t->n_spans = t->spans_size = 0;
+	t->bands = NULL;
+	t->spans = NULL;
+    }
+
+    return t;
+}
+
+PIXMAN_EXPORT void
+pixman_region32_table_destroy (pixman_region32_table_t *table)
+{
+    if (!table)
+	return;
+
+    clear_table (table);
+    free (table);
+}
+
+/* Replaces the contents of table with region.  Returns FALSE, leaving
+ * table empty, if memory runs out.
+ */
+PIXMAN_EXPORT pixman_bool_t
+pixman_region32_table_from_region (pixman_region32_table_t *table,
+                                   pixman_region32_t *      region)
+{
+    pixman_box32_t *rects, *box, *end;
+    int n, n_bands;
+
+    clear_table (table);
+
+    rects = pixman_region32_rectangles (region, &n);
+    end = rects + n;
+
+    for (n_bands = 0, box = rects; box != end; box++)
+    {
+	if (box == rects || box->y1 != box[-1].y1)
+	    n_bands++;
+    }
+
+    if (!reserve (table, n_bands, n))
+	goto bail;
+
+    for (box = rects; box != end; box++)
+    {
+	if (box == rects || box->y1 != box[-1].y1)
+	{
+	    band_t *band = &table->bands[table->n_bands++];
+
+	    band->y1 = box->y1;
+	    band->y2 = box->y2;
+	    band->first = table->n_spans;
+	}
+
+	table->spans[table->n_spans].x1 = box->x1;
+	table->spans[table->n_spans].x2 = box->x2;
+	table->n_spans++;
+    }
+
+    return TRUE;
+
+bail:
+    clear_table (table);
+    return FALSE;
+}
+
+/* Hands the bands of a table to pixman_region32_init_bands() */
+typedef struct
+{
+    pixman_region32_band_iter_t    iter;
+    const pixman_region32_table_t *table;
+    int                            band;
+    pixman_box32_t *               boxes;
+} table_iter_t;
+
+static pixman_bool_t
+table_iter_next (pixman_region32_band_iter_t *iter,
+		 const pixman_box32_t       **boxes,
+		 int *                        n_boxes)
+{
+    table_iter_t *ti = (table_iter_t *)iter;
+    const pixman_region32_table_t *t = ti->table;
+    const band_t *band;
+    int i, end;
+
+    if (ti->band == t->n_bands)
+	return FALSE;
+
+    band = &t->bands[ti->band];
+    end = BAND_END (t, ti->band);
+
+    for (i = band->first; i < end; i++)
+    {
+	pixman_box32_t *box = &ti->boxes[i - band->first];
+
+	box->x1 = t->spans[i].x1;
+	box->y1 = band->y1;
+	box->x2 = t->spans[i].x2;
+	box->y2 = band->y2;
+    }
+
+    *boxes = ti->boxes;
+    *n_boxes = end - band->first;
+    ti->band++;
+
+    return TRUE;
+}
+
+/* Initializes region with the boxes of table */
+PIXMAN_EXPORT pixman_bool_t
+pixman_region32_table_to_region (pixman_region32_table_t *table,
+                                 pixman_region32_t *      region)
+{
+    table_iter_t ti;
+    pixman_bool_t ret;
+    int i, widest = 0;
+
+    for (i = 0; i < table->n_bands; i++)
+	widest = MAX (widest, BAND_END (table, i) - (int)table->bands[i].first);
+
+    ti.iter.next = table_iter_next;
+    ti.iter.error = FALSE;
+    ti.table = table;
+    ti.band = 0;
+    ti.boxes = NULL;
+
+    if (widest)
+    {
+	ti.boxes = pixman_malloc_ab (widest, sizeof (pixman_box32_t));
+	if (!ti.boxes)
+	{
+	    pixman_region32_init (region);
+	    return FALSE;
+	}
+    }
+
+    ret = pixman_region32_init_bands (region, &ti.iter);
+    free (ti.boxes);
+
+    return ret;
+}
+
+PIXMAN_EXPORT int
+pixman_region32_table_n_bands (pixman_region32_table_t *table)
+{
+    return table->n_bands;
+}
+
+/* The number of x spans, which is the number of boxes of the region */
+PIXMAN_EXPORT int
+pixman_region32_table_n_spans (pixman_region32_table_t *table)
+{
+    return table->n_spans;
+}
+
+typedef enum
+{
+    TABLE_OP_UNION,
+    TABLE_OP_INTERSECT,
+    TABLE_OP_SUBTRACT
+} table_op_t;
+
+/* The span kernels.  Each merges two sorted, disjoint, non-touching span
+ * arrays into out, which has room for the spans of both, and returns
+ * the number of spans written.
+ */
+static int
+union_spans (span_t *out,
+	     const span_t *s1, const span_t *e1,
+	     const span_t *s2, const span_t *e2)
+{
+    span_t *o = out;
+    int32_t x1, x2;
+
+    while (s1 != e1 || s2 != e2)
+    {
+	const span_t *s;
+
+	if (s2 == e2 || (s1 != e1 && s1->x1 < s2->x1))
+	    s = s1++;
+	else
+	    s = s2++;
+
+	x1 = s->x1;
+	x2 = s->x2;
+
+	if (o != out && o[-1].x2 >= x1)
+	{
+	    if (o[-1].x2 < x2)
+		o[-1].x2 = x2;
+	}
+	else
+	{
+	    o->x1 = x1;
+	    o->x2 = x2;
+	    o++;
+	}
+    }
+
+    return o - out;
+}
+
+static int
+intersect_spans (span_t *out,
+		 const span_t *s1, const span_t *e1,
+		 const span_t *s2, const span_t *e2)
+{
+    span_t *o = out;
+
+    while (s1 != e1 && s2 != e2)
+    {
+	int32_t x1 = MAX (s1->x1, s2->x1);
+	int32_t x2 = MIN (s1->x2, s2->x2);
+
+	if (x1 < x2)
+	{
+	    o->x1 = x1;
+	    o->x2 = x2;
+	    o++;
+	}
+
+	if (s1->x2 == x2)
+	    s1++;
+	if (s2->x2 == x2)
+	    s2++;
+    }
+
+    return o - out;
+}
+
+static int
+subtract_spans (span_t *out,
+		const span_t *s1, const span_t *e1,
+		const span_t *s2, const span_t *e2)
+{
+    span_t *o = out;
+
+    while (s1 != e1)
+    {
+	int32_t x1 = s1->x1;
+
+	/* Subtrahends left of the minuend are of no more use */
+	while (s2 != e2 && s2->x2 <= x1)
+	    s2++;
+
+	while (s2 != e2 && s2->x1 < s1->x2)
+	{
+	    if (s2->x1 > x1)
+	    {
+		o->x1 = x1;
+		o->x2 = s2->x1;
+		o++;
+	    }
+
+	    x1 = s2->x2;
+	    if (x1 >= s1->x2)
+		break;
+
+	    s2++;
+	}
+
+	if (x1 < s1->x2)
+	{
+	    o->x1 = x1;
+	    o->x2 = s1->x2;
+	    o++;
+	}
+
+	s1++;
+    }
+
+    return o - out;
+}
+
+/* Adds the band [y1, y2) with the spans of band i of src */
+static void
+copy_band (pixman_region32_table_t *dst,
+	   const pixman_region32_table_t *src, int i,
+	   int y1, int y2)
+{
+    int first = dst->n_spans;
+    int n = BAND_END (src, i) - src->bands[i].first;
+
+    memcpy (&dst->spans[first], &src->spans[src->bands[i].first], n * sizeof (span_t));
+    dst->n_spans += n;
+
+    end_band (dst, first, y1, y2);
+}
+
+static pixman_bool_t
+table_op (pixman_region32_table_t *dst,
+	  pixman_region32_table_t *a,
+	  pixman_region32_table_t *b,
+	  table_op_t               op)
+{
+    pixman_region32_table_t out = { 0, 0, 0, 0, NULL, NULL };
+    pixman_bool_t keep_a = op != TABLE_OP_INTERSECT;
+    pixman_bool_t keep_b = op == TABLE_OP_UNION;
+    int32_t y = INT32_MIN;
+    int i = 0, j = 0;
+
+    /* Space is reserved a band at a time, so the kernels never need to
+     * check for it.
+     */
+    while (i < a->n_bands || j < b->n_bands)
+    {
+	const band_t *ba = i < a->n_bands ? &a->bands[i] : NULL;
+	const band_t *bb = j < b->n_bands ? &b->bands[j] : NULL;
+	int32_t ya = ba ? MAX (ba->y1, y) : INT32_MAX;
+	int32_t yb = bb ? MAX (bb->y1, y) : INT32_MAX;
+	int32_t bot;
+
+	if (!bb || (ba && ya < yb))
+	{
+	    /* Only a covers [ya, bot) */
+	    bot = bb ? MIN (ba->y2, yb) : ba->y2;
+
+	    if (!bb && !keep_a)
+		break;
+
+	    if (keep_a)
+	    {
+		if (!reserve (&out, 1, BAND_END (a, i) - ba->first))
+		    goto bail;
+
+		copy_band (&out, a, i, ya, bot);
+	    }
+
+	    y = bot;
+	    if (bot == ba->y2)
+		i++;
+	}
+	else if (!ba || yb < ya)
+	{
+	    /* Only b covers [yb, bot) */
+	    bot = ba ? MIN (bb->y2, ya) : bb->y2;
+
+	    if (!ba && !keep_b)
+		break;
+
+	    if (keep_b)
+	    {
+		if (!reserve (&out, 1, BAND_END (b, j) - bb->first))
+		    goto bail;
+
+		copy_band (&out, b, j, yb, bot);
+	    }
+
+	    y = bot;
+	    if (bot == bb->y2)
+		j++;
+	}
+	else
+	{
+	    const span_t *s1 = &a->spans[ba->first];
+	    const span_t *e1 = &a->spans[BAND_END (a, i)];
+	    const span_t *s2 = &b->spans[bb->first];
+	    const span_t *e2 = &b->spans[BAND_END (b, j)];
+	    int first;
+
+	    bot = MIN (ba->y2, bb->y2);
+
+	    if (!reserve (&out, 1, (e1 - s1) + (e2 - s2)))
+		goto bail;
+
+	    first = out.n_spans;
+
+	    switch (op)
+	    {
+	    case TABLE_OP_UNION:
+		out.n_spans += union_spans (&out.spans[first], s1, e1, s2, e2);
+		break;
+
+	    case TABLE_OP_INTERSECT:
+		out.n_spans += intersect_spans (&out.spans[first], s1, e1, s2, e2);
+		break;
+
+	    case TABLE_OP_SUBTRACT:
+		out.n_spans += subtract_spans (&out.spans[first], s1, e1, s2, e2);
+		break;
+	    }
+
+	    end_band (&out, first, ya, bot);
+
+	    y = bot;
+	    if (bot == ba->y2)
+		i++;
+	    if (bot == bb->y2)
+		j++;
+	}
+    }
+
+    /* dst may be a or b, so only replace it now */
+    clear_table (dst);
+    *dst = out;
+
+    return TRUE;
+
+bail:
+    clear_table (&out);
+    return FALSE;
+}
+
+PIXMAN_EXPORT pixman_bool_t
+pixman_region32_table_union (pixman_region32_table_t *dst,
+                             pixman_region32_table_t *a,
+                             pixman_region32_table_t *b)
+{
+    return table_op (dst, a, b, TABLE_OP_UNION);
+}
+
+PIXMAN_EXPORT pixman_bool_t
+pixman_region32_table_intersect (pixman_region32_table_t *dst,
+                                 pixman_region32_table_t *a,
+                                 pixman_region32_table_t *b)
+{
+    return table_op (dst, a, b, TABLE_OP_INTERSECT);
+}
+
+PIXMAN_EXPORT pixman_bool_t
+pixman_region32_table_subtract (pixman_region32_table_t *dst,
+                                pixman_region32_table_t *a,
+                                pixman_region32_table_t *b)
+{
+    return table_op (dst, a, b, TABLE_OP_SUBTRACT);
+}
@@ -0,0 +1,582 @@
+
+/*
+ * Copyright © 2008 Red Hat, Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * Red Hat, Inc. not be used in advertising or publicity pertaining to
+ * distribution of the software without specific, written prior
+ * permission. Red Hat, Inc. makes no representations about the
+ * suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * RED HAT, INC. DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL RED HAT, INC. BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR
+ * IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Tiled bitmap regions.
+ *
+ * Box lists are a poor fit for very fragmented coverage such as
+ * antialiased text or dithered masks, where there can be about one box
+ * per run of pixels.  This stores coverage as a grid of 64x64 pixel
+ * tiles instead: a tile is empty, full, or has a bitmap of 64 rows of
+ * one 64 bit word each.  Boolean operations work a tile at a time, with
+ * shortcuts for empty and full tiles and otherwise a loop over the 64
+ * words, so their cost depends on the covered area rather than on the
+ * number of boxes.  The grid only spans the tiles touched by the
+ * region's extents, and is meant for regions the size of a screen.
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "pixman-private.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define TILE_SHIFT	6
+#define TILE_SIZE	(1 << TILE_SHIFT)
+
+/* Rounds towards minus infinity, also for negative coordinates */
+#define TILE_OF(x)	((x) < 0 ? ~(~(x) >> TILE_SHIFT) : (x) >> TILE_SHIFT)
+
+/* Grids larger than this are refused rather than allocated */
+#define MAX_TILES	(1 << 24)
+
+typedef enum
+{
+    TILE_EMPTY,
+    TILE_FULL,
+    TILE_MIXED
+} tile_state_t;
+
+typedef struct
+{
+    tile_state_t state;
+    uint64_t *   bits;		/* TILE_SIZE rows, for TILE_MIXED only */
+} tile_t;
+
+struct pixman_region32_tiles
+{
+    int     tx, ty;		/* position of the first tile, in tiles */
+    int     width, height;	/* size of the grid, in tiles */
+    tile_t *tiles;
+};
+
+static void
+free_tiles (tile_t *tiles, int n_tiles)
+{
+    int i;
+
+    for (i = 0; i < n_tiles; i++)
+	free (tiles[i].bits);
+
+    free (tiles);
+}
+
+static tile_t *
+alloc_tiles (int width, int height)
+{
+    tile_t *tiles;
+
+    if (width <= 0 || height <= 0)
+	return NULL;
+
+    if (width > MAX_TILES / height)
+	return NULL;
+
+    tiles = pixman_malloc_ab (width * height, sizeof (tile_t));
+    if (tiles)
+	memset (tiles, 0, width * height * sizeof (tile_t));
+
+    return tiles;
+}
+
+static void
+set_grid (pixman_region32_tiles_t *t,
+	  int tx, int ty, int width, int height, tile_t *tiles)
+{
+    free_tiles (t->tiles, t->width * t->height);
+
+    t->tx = tx;
+    t->ty = ty;
+    t->width = width;
+    t->height = height;
+    t->tiles = tiles;
+}
+
+/* Turns bitmaps that are all zeros or all ones into empty or full tiles */
+static void
+normalize_tile (tile_t *tile)
+{
+    uint64_t all_or = 0, all_and = ~(uint64_t)0;
+    int i;
+
+    if (tile->state != TILE_MIXED)
+	return;
+
+    for (i = 0; i < TILE_SIZE; i++)
+    {
+	all_or |= tile->bits[i];
+	all_and &= tile->bits[i];
+    }
+
+    if (all_or && ~all_and)
+	return;
+
+    free (tile->bits);
+    tile->bits = NULL;
+    tile->state = all_or ? TILE_FULL : TILE_EMPTY;
+}
+
+static const tile_t empty_tile = { TILE_EMPTY, NULL };
+
+static const tile_t *
+get_tile (pixman_region32_tiles_t *t, int tx, int ty)
+{
+    tx -= t->tx;
+    ty -= t->ty;
+
+    if (tx < 0 || tx >= t->width || ty < 0 || ty >= t->height)
+	return &empty_tile;
+
+    return &t->tiles[ty * t->width + tx];
+}
+
+PIXMAN_EXPORT pixman_region32_tiles_t *
+pixman_region32_tiles_create (void)
+{
+    pixman_region32_tiles_t *t = malloc (sizeof (pixman_region32_tiles_t));
+
+    if (t)
+    {
+	t->tx = t->ty = 0;
+	t->width = t->height = 0;
+	t->tiles = NULL;
+    }
+
+    return t;
+}
+
+PIXMAN_EXPORT void
+pixman_region32_tiles_destroy (pixman_region32_tiles_t *tiles)
+{
+    if (!tiles)
+	return;
+
+    free_tiles (tiles->tiles, tiles->width * tiles->height);
+    free (tiles);
+}
+
+/* Replaces the contents of tiles with region.  Returns FALSE, leaving
+ * tiles empty, if memory runs out or the region is too large to tile.
+ */
+PIXMAN_EXPORT pixman_bool_t
+pixman_region32_tiles_from_region (pixman_region32_tiles_t *tiles,
+                                   pixman_region32_t *      region)
+{
+    pixman_box32_t *box, *end;
+    tile_t *grid;
+    int tx, ty, width, height;
+    int n;
+
+    set_grid (tiles, 0, 0, 0, 0, NULL);
+
+    if (!pixman_region32_not_empty (region))
+	return TRUE;
+
+    tx = TILE_OF (region->extents.x1);
+    ty = TILE_OF (region->extents.y1);
+    width = TILE_OF (region->extents.x2 - 1) - tx + 1;
+    height = TILE_OF (region->extents.y2 - 1) - ty + 1;
+
+    grid = alloc_tiles (width, height);
+    if (!grid)
+	return FALSE;
+
+    box = pixman_region32_rectangles (region, &n);
+
+    for (end = box + n; box != end; box++)
+    {
+	int i, j;
+
+	for (j = TILE_OF (box->y1); j <= TILE_OF (box->y2 - 1); j++)
+	{
+	    int64_t y0 = (int64_t)j * TILE_SIZE;
+	    int y1 = MAX (box->y1, y0) - y0;
+	    int y2 = MIN (box->y2, y0 + TILE_SIZE) - y0;
+
+	    for (i = TILE_OF (box->x1); i <= TILE_OF (box->x2 - 1); i++)
+	    {
+		tile_t *tile = &grid[(j - ty) * width + (i - tx)];
+		int64_t x0 = (int64_t)i * TILE_SIZE;
+		int x1 = MAX (box->x1, x0) - x0;
+		int x2 = MIN (box->x2, x0 + TILE_SIZE) - x0;
+		uint64_t mask;
+		int y;
+
+		if (tile->state == TILE_FULL)
+		    continue;
+
+		if (x1 == 0 && x2 == TILE_SIZE && y1 == 0 && y2 == TILE_SIZE)
+		{
+		    free (tile->bits);
+		    tile->bits = NULL;
+		    tile->state = TILE_FULL;
+		    continue;
+		}
+
+		if (tile->state == TILE_EMPTY)
+		{
+		    tile->bits = calloc (TILE_SIZE, sizeof (uint64_t));
+		    if (!tile->bits)
+		    {
+			free_tiles (grid, width * height);
+			return FALSE;
+		    }
+		    tile->state = TILE_MIXED;
+		}
+
+		mask = (x2 == TILE_SIZE ? ~(uint64_t)0 : ((uint64_t)1 << x2) - 1) &
+		    ~(((uint64_t)1 << x1) - 1);
+
+		for (y = y1; y < y2; y++)
+		    tile->bits[y] |= mask;
+	    }
+	}
+    }
+
+    for (n = 0; n < width * height; n++)
+	normalize_tile (&grid[n]);
+
+    set_grid (tiles, tx, ty, width, height, grid);
+
+    return TRUE;
+}
+
+static force_inline int
+lowest_bit (uint64_t word)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll (word);
+#else
+    int n = 0;
+
+    while (!(word & 1))
+    {
+	word >>= 1;
+	n++;
+    }
+
+    return n;
+#endif
+}
+
+typedef struct
+{
+    pixman_region32_span_t *spans;
+    int                     n_spans;
+    int                     size;
+} span_buffer_t;
+
+static pixman_bool_t
+add_span (span_buffer_t *buf, int y, int x1, int x2)
+{
+    if (buf->n_spans == buf->size)
+    {
+	pixman_region32_span_t *spans;
+	int size = buf->size ? buf->size * 2 : 256;
+
+	if (size < buf->size ||
+	    !(spans = pixman_malloc_ab (size, sizeof (pixman_region32_span_t))))
+	{
+	    return FALSE;
+	}
+
+	if (buf->n_spans)
+	    memcpy (spans, buf->spans, buf->n_spans * sizeof (pixman_region32_span_t));
+	free (buf->spans);
+
+	buf->spans = spans;
+	buf->size = size;
+    }
+
+    buf->spans[buf->n_spans].y = y;
+    buf->spans[buf->n_spans].x1 = x1;
+    buf->spans[buf->n_spans].x2 = x2;
+    buf->n_spans++;
+
+    return TRUE;
+}
+
+/* Initializes region with the pixels set in tiles.  Each scanline is
+ * turned into spans by looking for bit transitions, and the spans are
+ * coalesced into bands by pixman_region32_init_spans().
+ */
+PIXMAN_EXPORT pixman_bool_t
+pixman_region32_tiles_to_region (pixman_region32_tiles_t *tiles,
+                                 pixman_region32_t *      region)
+{
+    span_buffer_t buf = { NULL, 0, 0 };
+    pixman_bool_t ret;
+    int i, j, y;
+
+    for (j = 0; j < tiles->height; j++)
+    {
+	tile_t *row = &tiles->tiles[j * tiles->width];
+
+	for (y = 0; y < TILE_SIZE; y++)
+	{
+	    int py = ((int64_t)tiles->ty + j) * TILE_SIZE + y;
+	    pixman_bool_t in = FALSE;
+	    int start = 0;
+
+	    for (i = 0; i < tiles->width; i++)
+	    {
+		int64_t x0 = ((int64_t)tiles->tx + i) * TILE_SIZE;
+		uint64_t word;
+		int pos = 0;
+
+		if (row[i].state == TILE_MIXED)
+		    word = row[i].bits[y];
+		else
+		    word = row[i].state == TILE_FULL ? ~(uint64_t)0 : 0;
+
+		/* Look for the next change from the current state */
+		while (pos < TILE_SIZE)
+		{
+		    uint64_t rest = (in ? ~word : word) >> pos;
+
+		    if (!rest)
+			break;
+
+		    pos += lowest_bit (rest);
+
+		    if (in && !add_span (&buf, py, start, x0 + pos))
+			goto bail;
+
+		    start = x0 + pos;
+		    in = !in;
+		}
+	    }
+
+	    if (in && !add_span (&buf, py, start,
+				 MIN (((int64_t)tiles->tx + tiles->width) * TILE_SIZE, INT32_MAX)))
+	    {
+		goto bail;
+	    }
+	}
+    }
+
+    ret = pixman_region32_init_spans (region, buf.spans, buf.n_spans);
+    free (buf.spans);
+
+    return ret;
+
+bail:
+    free (buf.spans);
+    pixman_region32_init (region);
+
+    return FALSE;
+}
+
+typedef enum
+{
+    TILE_OP_UNION,
+    TILE_OP_INTERSECT,
+    TILE_OP_SUBTRACT
+} tile_op_t;
+
+/* Combines two tiles.  Empty and full tiles are handled without looking
+ * at any bits; otherwise the 64 words are combined in a simple loop that
+ * compilers vectorise.
+ */
+static pixman_bool_t
+combine_tile (tile_t *dst, const tile_t *a, const tile_t *b, tile_op_t op)
+{
+    const uint64_t *abits = a->bits, *bbits = b->bits;
+    const tile_t *copy = NULL;
+    uint64_t *bits;
+    int i;
+
+    switch (op)
+    {
+    case TILE_OP_UNION:
+	if (a->state == TILE_FULL || b->state == TILE_FULL)
+	{
+	    dst->state = TILE_FULL;
+	    return TRUE;
+	}
+	if (a->state == TILE_EMPTY)
+	    copy = b;
+	else if (b->state == TILE_EMPTY)
+	    copy = a;
+	break;
+
+    case TILE_OP_INTERSECT:
+	if (a->state == TILE_EMPTY || b->state == TILE_EMPTY)
+	    return TRUE;
+	if (a->state == TILE_FULL)
+	    copy = b;
+	else if (b->state == TILE_FULL)
+	    copy = a;
+	break;
+
+    case TILE_OP_SUBTRACT:
+	if (a->state == TILE_EMPTY || b->state == TILE_FULL)
+	    return TRUE;
+	if (b->state == TILE_EMPTY)
+	    copy = a;
+	break;
+    }
+
+    if (copy && copy->state != TILE_MIXED)
+    {
+	dst->state = copy->state;
+	return TRUE;
+    }
+
+    bits = malloc (TILE_SIZE * sizeof (uint64_t));
+    if (!bits)
+	return FALSE;
+
+    dst->state = TILE_MIXED;
+    dst->bits = bits;
+
+    if (copy)
+    {
+	memcpy (bits, copy->bits, TILE_SIZE * sizeof (uint64_t));
+	return TRUE;
+    }
+
+    switch (op)
+    {
+    case TILE_OP_UNION:
+	for (i = 0; i < TILE_SIZE; i++)
+	    bits[i] = abits[i] | bbits[i];
+	break;
+
+    case TILE_OP_INTERSECT:
+	for (i = 0; i < TILE_SIZE; i++)
+	    bits[i] = abits[i] & bbits[i];
+	break;
+
+    case TILE_OP_SUBTRACT:
+	if (a->state == TILE_FULL)
+	{
+	    for (i = 0; i < TILE_SIZE; i++)
+		bits[i] = ~bbits[i];
+	}
+	else
+	{
+	    for (i = 0; i < TILE_SIZE; i++)
+		bits[i] = abits[i] & ~bbits[i];
+	}
+	break;
+    }
+
+    normalize_tile (dst);
+
+    return TRUE;
+}
+
+static pixman_bool_t
+tiles_op (pixman_region32_tiles_t *dst,
+	  pixman_region32_tiles_t *a,
+	  pixman_region32_tiles_t *b,
+	  tile_op_t                op)
+{
+    int x1, y1, x2, y2;
+    tile_t *grid;
+    int i, j;
+
+    /* The grid of the result, in tiles */
+    if (op == TILE_OP_UNION)
+    {
+	if (!a->width)
+	    a = b;
+	else if (!b->width)
+	    b = a;
+
+	x1 = MIN (a->tx, b->tx);
+	y1 = MIN (a->ty, b->ty);
+	x2 = MAX (a->tx + a->width, b->tx + b->width);
+	y2 = MAX (a->ty + a->height, b->ty + b->height);
+    }
+    else if (op == TILE_OP_INTERSECT)
+    {
+	x1 = MAX (a->tx, b->tx);
+	y1 = MAX (a->ty, b->ty);
+	x2 = MIN (a->tx + a->width, b->tx + b->width);
+	y2 = MIN (a->ty + a->height, b->ty + b->height);
+    }
+    else
+    {
+	x1 = a->tx;
+	y1 = a->ty;
+	x2 = a->tx + a->width;
+	y2 = a->ty + a->height;
+    }
+
+    if (x1 >= x2 || y1 >= y2)
+    {
+	set_grid (dst, 0, 0, 0, 0, NULL);
+	return TRUE;
+    }
+
+    grid = alloc_tiles (x2 - x1, y2 - y1);
+    if (!grid)
+	return FALSE;
+
+    for (j = y1; j < y2; j++)
+    {
+	for (i = x1; i < x2; i++)
+	{
+	    if (!combine_tile (&grid[(j - y1) * (x2 - x1) + (i - x1)],
+			       get_tile (a, i, j), get_tile (b, i, j), op))
+	    {
+		free_tiles (grid, (x2 - x1) * (y2 - y1));
+		return FALSE;
+	    }
+	}
+    }
+
+    /* dst may be a or b, so only replace it now */
+    set_grid (dst, x1, y1, x2 - x1, y2 - y1, grid);
+
+    return TRUE;
+}
+
+PIXMAN_EXPORT pixman_bool_t
+pixman_region32_tiles_union (pixman_region32_tiles_t *dst,
+                             pixman_region32_tiles_t *a,
+                             pixman_region32_tiles_t *b)
+{
+    return tiles_op (dst, a, b, TILE_OP_UNION);
+}
+
+PIXMAN_EXPORT pixman_bool_t
+pixman_region32_tiles_intersect (pixman_region32_tiles_t *dst,
+                                 pixman_region32_tiles_t *a,
+                                 pixman_region32_tiles_t *b)
+{
+    return tiles_op (dst, a, b, TILE_OP_INTERSECT);
+}
+
+PIXMAN_EXPORT pixman_bool_t
+pixman_region32_tiles_subtract (pixman_region32_tiles_t *dst,
+                                pixman_region32_tiles_t *a,
+                                pixman_region32_tiles_t *b)
+{
+    return tiles_op (dst, a, b, TILE_OP_SUBTRACT);
+}
@@ -36,6 +36,15 @@
 typedef pixman_box16_t		box_type_t;
 typedef pixman_region16_data_t	region_data_type_t;
 typedef pixman_region16_t	region_type_t;
+typedef pixman_region16_span_t	span_type_t;
+typedef pixman_region16_span_iter_t span_iter_type_t;
+typedef pixman_region16_flat_t	flat_type_t;
+typedef pixman_region_flat_band_t flat_band_type_t;
+typedef pixman_region16_band_iter_t band_iter_type_t;
+typedef pixman_region16_band_source_t band_source_type_t;
+typedef pixman_region16_band_op_t band_op_type_t;
+typedef int                     coord_type_t;
+typedef unsigned int            coord_size_t;
 typedef int32_t                 overflow_int_t;
 
 typedef struct {
@@ -47,6 +56,8 @@ typedef struct {
 #define PIXMAN_REGION_MAX INT16_MAX
 #define PIXMAN_REGION_MIN INT16_MIN
 
+#define PIXMAN_REGION_OVERRIDABLE_STATIC_POINTERS
+
 #include "pixman-region.c.inc"
 
 /* This function exists only to make it possible to preserve the X ABI -
@@ -57,11 +68,23 @@ typedef struct {
  * the addresses of those structs which makes the existing code continue to
  * work.
  */
+static volatile int static_pointers_set = 0;
+
 PIXMAN_EXPORT void
 pixman_region_set_static_pointers (pixman_box16_t *empty_box,
 				   pixman_region16_data_t *empty_data,
 				   pixman_region16_data_t *broken_data)
 {
+    /* The pointers are read without synchronisation on every region
+     * operation, so they may only be replaced once, before any 16 bit
+     * region is in use.
+     */
+    if (!pixman_atomic_cas_int (&static_pointers_set, 0, 1))
+    {
+	_pixman_log_error (FUNC, "Static pointers may only be set once");
+	return;
+    }
+
     pixman_region_empty_box = empty_box;
     pixman_region_empty_data = empty_data;
     pixman_broken_data = broken_data;
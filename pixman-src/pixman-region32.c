@@ -34,6 +34,15 @@
 typedef pixman_box32_t		box_type_t;
 typedef pixman_region32_data_t	region_data_type_t;
 typedef pixman_region32_t	region_type_t;
+typedef pixman_region32_span_t	span_type_t;
+typedef pixman_region32_span_iter_t span_iter_type_t;
+typedef pixman_region32_flat_t	flat_type_t;
+typedef pixman_region_flat_band_t flat_band_type_t;
+typedef pixman_region32_band_iter_t band_iter_type_t;
+typedef pixman_region32_band_source_t band_source_type_t;
+typedef pixman_region32_band_op_t band_op_type_t;
+typedef int                     coord_type_t;
+typedef unsigned int            coord_size_t;
 typedef int64_t                 overflow_int_t;
 
 typedef struct {
@@ -0,0 +1,64 @@
+
+/*
+ * Copyright © 2008 Red Hat, Inc.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * Red Hat, Inc. not be used in advertising or publicity pertaining to
+ * distribution of the software without specific, written prior
+ * permission. Red Hat, Inc. makes no representations about the
+ * suitability of this software for any purpose.  It is provided "as
+ * is" without express or implied warranty.
+ *
+ * RED HAT, INC. DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL RED HAT, INC. BE LIABLE FOR ANY SPECIAL,
+ * INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION
+ * OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR
+ * IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * Author: Soren Sandmann <sandmann@redhat.com>
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "pixman-private.h"
+
+#include <stdlib.h>
+
+/* 64 bit regions compute with 128 bit integers to avoid overflow, so
+ * they are only built where the compiler has them.
+ */
+#ifdef __SIZEOF_INT128__
+
+typedef pixman_box64_t		box_type_t;
+typedef pixman_region64_data_t	region_data_type_t;
+typedef pixman_region64_t	region_type_t;
+typedef pixman_region64_span_t	span_type_t;
+typedef pixman_region64_span_iter_t span_iter_type_t;
+typedef pixman_region64_flat_t	flat_type_t;
+typedef pixman_region64_flat_band_t flat_band_type_t;
+typedef pixman_region64_band_iter_t band_iter_type_t;
+typedef pixman_region64_band_source_t band_source_type_t;
+typedef pixman_region64_band_op_t band_op_type_t;
+typedef int64_t                 coord_type_t;
+typedef uint64_t                coord_size_t;
+typedef __int128                overflow_int_t;
+
+typedef struct {
+    int64_t x, y;
+} point_type_t;
+
+#define PREFIX(x) pixman_region64##x
+
+#define PIXMAN_REGION_MAX INT64_MAX
+#define PIXMAN_REGION_MIN INT64_MIN
+
+#include "pixman-region.c.inc"
+
+#endif /* __SIZEOF_INT128__ */
@@ -306,16 +306,14 @@ pixman_region32_copy_from_region16 (pixman_region32_t *dst,
 void
 _pixman_log_error (const char *function, const char *message)
 {
-    static int n_messages = 0;
+    static volatile int n_messages = 0;
 
-    if (n_messages < 10)
+    if (pixman_atomic_fetch_add_int (&n_messages, 1) < 10)
     {
 	fprintf (stderr,
 		 "*** BUG ***\n"
 		 "In %s: %s\n"
 		 "Set a breakpoint on '_pixman_log_error' to debug\n\n",
                  function, message);
-
-	n_messages++;
     }
 }
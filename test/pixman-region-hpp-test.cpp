@@ -0,0 +1,200 @@
+/*
+ * Tests of the C++ wrapper, run from main () in pixman-region-test.c
+ */
+#include <cassert>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include "pixman-region/PixmanRegion.hpp"
+#include "pixman-region/BasicRegion.hpp"
+
+extern "C" void test_region_expr (void);
+extern "C" void test_basic_region (void);
+
+/* Containers only move elements on reallocation if that cannot throw */
+static_assert (std::is_nothrow_move_constructible<PixmanRegion>::value,
+	       "PixmanRegion moves must be noexcept");
+static_assert (std::is_nothrow_move_assignable<PixmanRegion>::value,
+	       "PixmanRegion moves must be noexcept");
+
+static uint32_t seed = 1;
+
+static int
+rand_n (int n)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % n;
+}
+
+static PixmanRegion
+random_region (void)
+{
+    PixmanRegion region;
+    int i, n = rand_n (20);
+
+    for (i = 0; i < n; i++)
+    {
+	PixmanRegion box (rand_n (200) - 50, rand_n (200) - 50,
+			  rand_n (60) + 1, rand_n (60) + 1);
+	region = region.unionRegion (box);
+    }
+
+    return region;
+}
+
+static bool
+same (PixmanRegion const &a, PixmanRegion const &b)
+{
+    return (a.isEmpty () && b.isEmpty ()) || a == b;
+}
+
+void
+test_region_expr (void)
+{
+    int i;
+
+    for (i = 0; i < 500; i++)
+    {
+	PixmanRegion a = random_region ();
+	PixmanRegion b = random_region ();
+	PixmanRegion c = random_region ();
+	PixmanRegion d = random_region ();
+	PixmanRegion r;
+
+	r = (a | b) - (c & d);
+	assert (same (r, a.unionRegion (b).subtractRegion (c.intersectRegion (d))));
+
+	PixmanRegion s = a & (b | c | d);
+	assert (same (s, a.intersectRegion (b.unionRegion (c).unionRegion (d))));
+
+	r = a - b - c;
+	assert (same (r, a.subtractRegion (b).subtractRegion (c)));
+
+	/* The expression may use the region it is assigned to */
+	r = (r | a) & b;
+	assert (same (r, a.subtractRegion (b).subtractRegion (c).unionRegion (a).intersectRegion (b)));
+
+	r = (a ^ b) & c;
+	assert (same (a.xorRegion (b), a.subtractRegion (b).unionRegion (b.subtractRegion (a))));
+	assert (same (r, a.xorRegion (b).intersectRegion (c)));
+
+	/* Disjoint extents take the short cuts */
+	PixmanRegion far (1000, 1000, 10, 10);
+	r = (a & far) | (b - far);
+	assert (same (r, b));
+	r = far - a;
+	assert (same (r, far));
+    }
+}
+
+typedef BasicRegion<int32_t> Region32;
+typedef BasicRegion<int64_t> Region64;
+
+/* Builds the same random region both ways */
+static void
+random_basic_region (Region32 *region, pixman_region32_t *pregion)
+{
+    int i, n = rand_n (30);
+
+    *region = Region32 ();
+    pixman_region32_init (pregion);
+
+    for (i = 0; i < n; i++)
+    {
+	int x = rand_n (200) - 50, y = rand_n (200) - 50;
+	int w = rand_n (60) + 1, h = rand_n (60) + 1;
+	Region32::Box box = { x, y, x + w, y + h };
+
+	*region = region->unionRegion (Region32 (box));
+	pixman_region32_union_rect (pregion, pregion, x, y, w, h);
+    }
+}
+
+static bool
+same_boxes (Region32 const &region, pixman_region32_t *pregion)
+{
+    int n;
+    pixman_box32_t *boxes = pixman_region32_rectangles (pregion, &n);
+
+    if ((size_t)n != region.numRects ())
+	return false;
+
+    return n == 0 || memcmp (boxes, region.getBoxes (), n * sizeof (*boxes)) == 0;
+}
+
+void
+test_basic_region (void)
+{
+    int i;
+
+    for (i = 0; i < 500; i++)
+    {
+	Region32 a, b;
+	pixman_region32_t pa, pb, pr;
+	int x, y;
+
+	random_basic_region (&a, &pa);
+	random_basic_region (&b, &pb);
+	pixman_region32_init (&pr);
+
+	/* Same algorithm, so exactly the same boxes */
+	assert (same_boxes (a, &pa));
+
+	pixman_region32_union (&pr, &pa, &pb);
+	assert (same_boxes (a.unionRegion (b), &pr));
+	pixman_region32_intersect (&pr, &pa, &pb);
+	assert (same_boxes (a.intersectRegion (b), &pr));
+	pixman_region32_subtract (&pr, &pa, &pb);
+	assert (same_boxes (a.subtractRegion (b), &pr));
+
+	for (x = -60; x < 160; x += 7)
+	{
+	    for (y = -60; y < 160; y += 5)
+	    {
+		assert (a.containsPoint (x, y) ==
+			!!pixman_region32_contains_point (&pa, x, y, NULL));
+	    }
+	}
+
+	/* 64 bit coordinates, far beyond the 32 bit range */
+	Region64 a64, b64;
+	const int64_t far = (int64_t)1 << 40;
+	Region32::Box const *bboxes;
+	pixman_box32_t const *boxes;
+	int n, j;
+
+	pixman_region32_fini (&pr);
+	pixman_region32_init (&pr);
+	pixman_region32_union (&pr, &pa, &pb);
+
+	bboxes = a.getBoxes ();
+	for (j = 0; j < (int)a.numRects (); j++)
+	{
+	    Region64::Box box = { bboxes[j].x1, bboxes[j].y1, bboxes[j].x2, bboxes[j].y2 };
+	    a64 = a64.unionRegion (Region64 (box));
+	}
+	bboxes = b.getBoxes ();
+	for (j = 0; j < (int)b.numRects (); j++)
+	{
+	    Region64::Box box = { bboxes[j].x1 + far, bboxes[j].y1 - far,
+				  bboxes[j].x2 + far, bboxes[j].y2 - far };
+	    b64 = b64.unionRegion (Region64 (box));
+	}
+	b64.translate (-far, far);
+	a64 = a64.unionRegion (b64);
+
+	boxes = pixman_region32_rectangles (&pr, &n);
+	assert ((size_t)n == a64.numRects ());
+	for (j = 0; j < n; j++)
+	{
+	    Region64::Box const &box = a64.getBoxes ()[j];
+
+	    assert (box.x1 == boxes[j].x1 && box.y1 == boxes[j].y1);
+	    assert (box.x2 == boxes[j].x2 && box.y2 == boxes[j].y2);
+	}
+
+	pixman_region32_fini (&pa);
+	pixman_region32_fini (&pb);
+	pixman_region32_fini (&pr);
+    }
+}
@@ -3,6 +3,1692 @@
 #include <stdio.h>
 #include "utils.h"
 
+#ifdef HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
+/* in pixman-region-hpp-test.cpp */
+void test_region_expr (void);
+void test_basic_region (void);
+
+static void
+random_region (prng_t *prng, pixman_region32_t *region, int n_boxes, int size)
+{
+    int i;
+
+    pixman_region32_init (region);
+
+    for (i = 0; i < n_boxes; i++)
+    {
+	pixman_region32_union_rect (region, region,
+				    prng_rand_r (prng) % size,
+				    prng_rand_r (prng) % size,
+				    prng_rand_r (prng) % 40 + 1,
+				    prng_rand_r (prng) % 40 + 1);
+    }
+}
+
+/* Like pixman_region32_equal(), but empty regions are all the same
+ * whatever their (meaningless) extents.
+ */
+static pixman_bool_t
+same_region (pixman_region32_t *a, pixman_region32_t *b)
+{
+    if (!pixman_region32_not_empty (a) || !pixman_region32_not_empty (b))
+	return pixman_region32_not_empty (a) == pixman_region32_not_empty (b);
+
+    return pixman_region32_equal (a, b);
+}
+
+static uint32_t
+region_crc32 (uint32_t crc, pixman_region32_t *region)
+{
+    pixman_box32_t *boxes;
+    int n;
+
+    boxes = pixman_region32_rectangles (region, &n);
+
+    crc = compute_crc32 (crc, &n, sizeof (n));
+    return compute_crc32 (crc, boxes, n * sizeof (pixman_box32_t));
+}
+
+/* Runs a mix of every region operation on regions private to the caller
+ * and returns a checksum of the results.
+ */
+static uint32_t
+region_workload (uint32_t seed)
+{
+    pixman_region32_t a, b, c;
+    pixman_box32_t inv = { 0, 0, 300, 300 };
+    prng_t prng;
+    uint32_t crc = 0;
+    int i;
+
+    prng_srand_r (&prng, seed);
+
+    for (i = 0; i < 20; i++)
+    {
+	random_region (&prng, &a, 50, 256);
+	random_region (&prng, &b, 50, 256);
+	pixman_region32_init (&c);
+
+	pixman_region32_union (&c, &a, &b);
+	crc = region_crc32 (crc, &c);
+	pixman_region32_intersect (&c, &a, &b);
+	crc = region_crc32 (crc, &c);
+	pixman_region32_subtract (&c, &a, &b);
+	crc = region_crc32 (crc, &c);
+	pixman_region32_inverse (&c, &c, &inv);
+	crc = region_crc32 (crc, &c);
+	pixman_region32_translate (&c, 7, -3);
+	pixman_region32_intersect_rect (&c, &c, 10, 10, 200, 200);
+	crc = region_crc32 (crc, &c);
+	crc += pixman_region32_contains_point (&a, 100, 100, NULL);
+	crc += pixman_region32_contains_rectangle (&b, &inv);
+	crc += pixman_region32_equal (&a, &c);
+	pixman_region32_copy (&b, &c);
+	crc = region_crc32 (crc, &b);
+
+	pixman_region32_fini (&a);
+	pixman_region32_fini (&b);
+	pixman_region32_fini (&c);
+    }
+
+    return crc;
+}
+
+#ifdef HAVE_PTHREADS
+
+#define N_THREADS 8
+
+typedef struct
+{
+    pthread_t thread;
+    uint32_t  seed;
+    uint32_t  crc;
+} workload_thread_t;
+
+static void *
+workload_thread (void *data)
+{
+    workload_thread_t *t = data;
+
+    t->crc = region_workload (t->seed);
+
+    return NULL;
+}
+
+/* Every region function must be safe to call concurrently on distinct
+ * regions: each thread has to get exactly the results it gets alone.
+ */
+static void
+test_concurrent_regions (void)
+{
+    workload_thread_t threads[N_THREADS];
+    int i;
+
+    for (i = 0; i < N_THREADS; i++)
+	threads[i].seed = 1000 + i;
+
+    for (i = 0; i < N_THREADS; i++)
+	assert (pthread_create (&threads[i].thread, NULL, workload_thread, &threads[i]) == 0);
+
+    for (i = 0; i < N_THREADS; i++)
+	assert (pthread_join (threads[i].thread, NULL) == 0);
+
+    for (i = 0; i < N_THREADS; i++)
+	assert (threads[i].crc == region_workload (threads[i].seed));
+}
+
+#endif
+
+/* An executor that runs tasks on throwaway threads when it can, and
+ * otherwise serially in reverse order, which is still a valid schedule.
+ */
+typedef struct
+{
+    pixman_region_task_t task;
+    void *               task_data;
+    int                  n_tasks;
+    int                  next;
+#ifdef HAVE_PTHREADS
+    pthread_mutex_t      mutex;
+#endif
+} test_job_t;
+
+#ifdef HAVE_PTHREADS
+static void *
+test_executor_thread (void *data)
+{
+    test_job_t *job = data;
+    int i;
+
+    for (;;)
+    {
+	pthread_mutex_lock (&job->mutex);
+	i = job->next++;
+	pthread_mutex_unlock (&job->mutex);
+
+	if (i >= job->n_tasks)
+	    return NULL;
+
+	job->task (job->task_data, i);
+    }
+}
+#endif
+
+static void
+test_executor_run (pixman_region_executor_t *executor,
+		   pixman_region_task_t      task,
+		   void                     *task_data,
+		   int                       n_tasks)
+{
+    test_job_t job;
+    int i;
+
+    (void) executor;
+
+    job.task = task;
+    job.task_data = task_data;
+    job.n_tasks = n_tasks;
+    job.next = 0;
+
+#ifdef HAVE_PTHREADS
+    {
+	pthread_t threads[4];
+
+	pthread_mutex_init (&job.mutex, NULL);
+	for (i = 0; i < 4; i++)
+	    assert (pthread_create (&threads[i], NULL, test_executor_thread, &job) == 0);
+	for (i = 0; i < 4; i++)
+	    pthread_join (threads[i], NULL);
+	pthread_mutex_destroy (&job.mutex);
+    }
+#else
+    for (i = n_tasks; i--; )
+	task (task_data, i);
+#endif
+}
+
+static void
+test_parallel_ops (void)
+{
+    pixman_region_executor_t executor = { test_executor_run, 7, 0, NULL };
+    pixman_region32_t a, b, serial, parallel;
+    prng_t prng;
+    int i;
+
+    prng_srand_r (&prng, 42);
+
+    for (i = 0; i < 30; i++)
+    {
+	random_region (&prng, &a, 200, 1000);
+	random_region (&prng, &b, i % 3 ? 200 : 2, 1000);
+	pixman_region32_init (&serial);
+	pixman_region32_init (&parallel);
+
+	pixman_region32_union (&serial, &a, &b);
+	assert (pixman_region32_union_parallel (&parallel, &a, &b, &executor));
+	assert (pixman_region32_selfcheck (&parallel));
+	assert (same_region (&serial, &parallel));
+
+	pixman_region32_intersect (&serial, &a, &b);
+	assert (pixman_region32_intersect_parallel (&parallel, &a, &b, &executor));
+	assert (pixman_region32_selfcheck (&parallel));
+	assert (same_region (&serial, &parallel));
+
+	pixman_region32_subtract (&serial, &a, &b);
+	assert (pixman_region32_subtract_parallel (&a, &a, &b, &executor));
+	assert (pixman_region32_selfcheck (&a));
+	assert (same_region (&serial, &a));
+
+	pixman_region32_fini (&a);
+	pixman_region32_fini (&b);
+	pixman_region32_fini (&serial);
+	pixman_region32_fini (&parallel);
+    }
+}
+
+static void
+test_union_many (void)
+{
+    pixman_region_executor_t executor = { test_executor_run, 4, 0, NULL };
+    pixman_region32_t regions[70];
+    pixman_region32_t serial, many;
+    prng_t prng;
+    int n, i;
+
+    prng_srand_r (&prng, 7);
+
+    for (n = 0; n <= 70; n += 7)
+    {
+	pixman_region32_init (&serial);
+	for (i = 0; i < n; i++)
+	{
+	    random_region (&prng, &regions[i], i % 5 ? 20 : 0, 500);
+	    pixman_region32_union (&serial, &serial, &regions[i]);
+	}
+
+	pixman_region32_init (&many);
+	assert (pixman_region32_union_many (&many, regions, n, &executor));
+	assert (pixman_region32_selfcheck (&many));
+	assert (same_region (&serial, &many));
+
+	assert (pixman_region32_union_many (&many, regions, n, NULL));
+	assert (same_region (&serial, &many));
+
+	for (i = 0; i < n; i++)
+	    pixman_region32_fini (&regions[i]);
+	pixman_region32_fini (&serial);
+	pixman_region32_fini (&many);
+    }
+}
+
+static void
+test_init_rects_parallel (void)
+{
+    pixman_region_executor_t executor = { test_executor_run, 6, 1000, NULL };
+    pixman_region32_t serial, parallel;
+    pixman_box32_t *boxes;
+    prng_t prng;
+    int n, i;
+
+    prng_srand_r (&prng, 1234);
+
+    boxes = malloc (20000 * sizeof (pixman_box32_t));
+
+    for (n = 10; n <= 20000; n *= 3)
+    {
+	for (i = 0; i < n; i++)
+	{
+	    boxes[i].x1 = prng_rand_r (&prng) % 2000;
+	    boxes[i].y1 = prng_rand_r (&prng) % 2000;
+	    boxes[i].x2 = boxes[i].x1 + prng_rand_r (&prng) % 50;
+	    boxes[i].y2 = boxes[i].y1 + prng_rand_r (&prng) % 50;
+	}
+
+	assert (pixman_region32_init_rects (&serial, boxes, n));
+	assert (pixman_region32_init_rects_parallel (&parallel, boxes, n, &executor));
+	assert (pixman_region32_selfcheck (&parallel));
+	assert (same_region (&serial, &parallel));
+
+	pixman_region32_fini (&serial);
+	pixman_region32_fini (&parallel);
+    }
+
+    free (boxes);
+}
+
+/* Copies share their rectangles; modifying either side must not be
+ * visible through the other.
+ */
+static void
+test_copy_on_write (void)
+{
+    pixman_region32_t a, b, c, expected;
+    prng_t prng;
+    uint32_t crc;
+
+    prng_srand_r (&prng, 99);
+    random_region (&prng, &a, 100, 500);
+    random_region (&prng, &c, 100, 500);
+    pixman_region32_init (&b);
+    pixman_region32_init (&expected);
+
+    assert (pixman_region32_n_rects (&a) > 1);
+    crc = region_crc32 (0, &a);
+
+    /* Translating a copy */
+    pixman_region32_copy (&b, &a);
+    assert (pixman_region32_rectangles (&a, NULL) == pixman_region32_rectangles (&b, NULL));
+    pixman_region32_translate (&b, 10, 10);
+    assert (region_crc32 (0, &a) == crc);
+    pixman_region32_translate (&b, -10, -10);
+    assert (pixman_region32_equal (&a, &b));
+
+    /* Using a copy as the destination of an operation on the original */
+    pixman_region32_copy (&b, &a);
+    pixman_region32_union (&expected, &a, &c);
+    pixman_region32_union (&b, &a, &c);
+    assert (region_crc32 (0, &a) == crc);
+    assert (pixman_region32_equal (&b, &expected));
+
+    /* Modifying the original in place */
+    pixman_region32_copy (&b, &a);
+    pixman_region32_subtract (&a, &a, &c);
+    assert (region_crc32 (0, &b) == crc);
+
+    pixman_region32_fini (&a);
+    assert (region_crc32 (0, &b) == crc);
+
+    pixman_region32_fini (&b);
+    pixman_region32_fini (&c);
+    pixman_region32_fini (&expected);
+}
+
+static void
+test_hash (void)
+{
+    pixman_region32_t a, b, c;
+    pixman_box32_t *boxes;
+    uint64_t hash;
+    prng_t prng;
+    int n;
+
+    prng_srand_r (&prng, 7);
+    random_region (&prng, &a, 100, 500);
+    random_region (&prng, &c, 100, 500);
+    pixman_region32_init (&b);
+
+    /* Equal regions hash equal, whether or not they share rectangles */
+    hash = pixman_region32_hash (&a);
+    pixman_region32_copy (&b, &a);
+    assert (pixman_region32_hash (&b) == hash);
+
+    boxes = pixman_region32_rectangles (&a, &n);
+    pixman_region32_fini (&b);
+    pixman_region32_init_rects (&b, boxes, n);
+    assert (pixman_region32_equal (&a, &b));
+    assert (pixman_region32_hash (&b) == hash);
+
+    /* Changing the rectangles in place drops the cached hash */
+    pixman_region32_translate (&b, 1, 0);
+    assert (pixman_region32_hash (&b) != hash);
+    assert (!pixman_region32_equal (&a, &b));
+    pixman_region32_translate (&b, -1, 0);
+    assert (pixman_region32_hash (&b) == hash);
+
+    pixman_region32_union (&b, &b, &c);
+    pixman_region32_union (&c, &a, &c);
+    assert (pixman_region32_equal (&b, &c));
+    assert (pixman_region32_hash (&b) == pixman_region32_hash (&c));
+
+    /* Same number of boxes, one of them different */
+    boxes = malloc (n * sizeof (pixman_box32_t));
+    memcpy (boxes, pixman_region32_rectangles (&a, NULL), n * sizeof (pixman_box32_t));
+    boxes[n - 1].x2++;
+    pixman_region32_fini (&c);
+    pixman_region32_init_rects (&c, boxes, n);
+    assert (pixman_region32_n_rects (&c) == n);
+    free (boxes);
+    assert (pixman_region32_hash (&c) != hash);
+    assert (!pixman_region32_equal (&a, &c));
+
+    /* Single box and empty regions */
+    pixman_region32_fini (&b);
+    pixman_region32_fini (&c);
+    pixman_region32_init_rect (&b, 1, 2, 3, 4);
+    pixman_region32_init_rect (&c, 1, 2, 3, 4);
+    assert (pixman_region32_hash (&b) == pixman_region32_hash (&c));
+    pixman_region32_clear (&b);
+    pixman_region32_subtract (&c, &c, &c);
+    assert (pixman_region32_hash (&b) == pixman_region32_hash (&c));
+
+    pixman_region32_fini (&a);
+    pixman_region32_fini (&b);
+    pixman_region32_fini (&c);
+}
+
+static uint64_t
+naive_area (pixman_region32_t *region, pixman_box32_t *clip)
+{
+    pixman_box32_t *boxes;
+    uint64_t area = 0;
+    int i, n;
+
+    boxes = pixman_region32_rectangles (region, &n);
+    for (i = 0; i < n; i++)
+    {
+	int x1 = MAX (boxes[i].x1, clip->x1), x2 = MIN (boxes[i].x2, clip->x2);
+	int y1 = MAX (boxes[i].y1, clip->y1), y2 = MIN (boxes[i].y2, clip->y2);
+
+	if (x1 < x2 && y1 < y2)
+	    area += (uint64_t)(x2 - x1) * (y2 - y1);
+    }
+
+    return area;
+}
+
+static void
+test_area (void)
+{
+    pixman_box32_t screen = { -100, -100, 1000, 1000 };
+    pixman_region32_t a, b;
+    prng_t prng;
+    int i;
+
+    prng_srand_r (&prng, 11);
+    pixman_region32_init (&b);
+
+    for (i = 0; i < 50; i++)
+    {
+	pixman_box32_t box;
+	uint64_t area;
+
+	random_region (&prng, &a, prng_rand_r (&prng) % 200, 600);
+	area = naive_area (&a, &screen);
+
+	assert (pixman_region32_area (&a) == area);
+	assert (pixman_region32_area (&a) == area);
+	assert (pixman_region32_coverage_ratio (&a, &screen) ==
+		(double)area / (1100 * 1100));
+
+	box.x1 = prng_rand_r (&prng) % 600;
+	box.y1 = prng_rand_r (&prng) % 600;
+	box.x2 = box.x1 + prng_rand_r (&prng) % 200 + 1;
+	box.y2 = box.y1 + prng_rand_r (&prng) % 200 + 1;
+	assert (pixman_region32_coverage_ratio (&a, &box) ==
+		(double)naive_area (&a, &box) /
+		((box.x2 - box.x1) * (box.y2 - box.y1)));
+
+	/* The cached area follows changes to the region */
+	pixman_region32_copy (&b, &a);
+	pixman_region32_union_rect (&b, &b, 700, 700, 10, 10);
+	assert (pixman_region32_area (&b) == area + 100);
+	assert (pixman_region32_area (&a) == area);
+	pixman_region32_translate (&b, 5000, 0);
+	assert (pixman_region32_area (&b) == area + 100);
+	assert (pixman_region32_coverage_ratio (&b, &screen) == 0.0);
+	pixman_region32_intersect_rect (&a, &a, box.x1, box.y1,
+					box.x2 - box.x1, box.y2 - box.y1);
+	assert (pixman_region32_area (&a) == naive_area (&a, &screen));
+
+	pixman_region32_fini (&a);
+    }
+
+    pixman_region32_fini (&b);
+}
+
+static void
+test_simplify (void)
+{
+    pixman_region32_t a, b, c;
+    prng_t prng;
+    int i;
+
+    prng_srand_r (&prng, 13);
+    pixman_region32_init (&b);
+    pixman_region32_init (&c);
+
+    for (i = 0; i < 200; i++)
+    {
+	int max_boxes = prng_rand_r (&prng) % 40;
+	uint64_t budget = (i & 1) ? prng_rand_r (&prng) % 20000 : 0;
+	uint64_t area;
+
+	random_region (&prng, &a, prng_rand_r (&prng) % 300, 800);
+	area = pixman_region32_area (&a);
+
+	assert (pixman_region32_simplify (&b, &a, max_boxes, budget));
+	assert (pixman_region32_selfcheck (&b));
+	assert (pixman_region32_n_rects (&b) <= MAX (max_boxes, 1));
+
+	/* b covers a */
+	pixman_region32_subtract (&c, &a, &b);
+	assert (!pixman_region32_not_empty (&c));
+
+	/* The budget only applies once there are few enough boxes */
+	if (pixman_region32_n_rects (&a) <= max_boxes)
+	    assert (pixman_region32_area (&b) - area <= budget);
+
+	/* In place */
+	pixman_region32_simplify (&a, &a, max_boxes, budget);
+	assert (pixman_region32_equal (&a, &b));
+
+	pixman_region32_fini (&a);
+    }
+
+    /* Down to one box, the extents */
+    random_region (&prng, &a, 100, 800);
+    pixman_region32_simplify (&b, &a, 1, 0);
+    assert (pixman_region32_n_rects (&b) == 1);
+    assert (memcmp (pixman_region32_extents (&a), pixman_region32_extents (&b),
+		    sizeof (pixman_box32_t)) == 0);
+    pixman_region32_fini (&a);
+
+    /* A column of glyph-like boxes with small gaps between them stacks
+     * into one box per column rather than filling between columns
+     */
+    pixman_region32_clear (&b);
+    for (i = 0; i < 20; i++)
+    {
+	pixman_region32_union_rect (&b, &b, 0, i * 12, 10, 10);
+	pixman_region32_union_rect (&b, &b, 100, i * 12, 10, 10);
+    }
+    pixman_region32_simplify (&c, &b, 2, 0);
+    assert (pixman_region32_n_rects (&c) == 2);
+    assert (pixman_region32_area (&c) == 2 * 10 * (19 * 12 + 10));
+
+    /* Gaps wider than the coordinate type can hold */
+    pixman_region32_init_rect (&a, INT32_MIN + 1, 0, 9, 10);
+    pixman_region32_union_rect (&a, &a, INT32_MAX - 10, 0, 9, 10);
+    assert (pixman_region32_simplify (&b, &a, 1, 0));
+    assert (pixman_region32_n_rects (&b) == 1);
+    assert (pixman_region32_extents (&b)->x1 == INT32_MIN + 1);
+    assert (pixman_region32_extents (&b)->x2 == INT32_MAX - 1);
+    assert (pixman_region32_simplify (&c, &a, 2, 0));
+    assert (pixman_region32_equal (&c, &a));
+    pixman_region32_fini (&a);
+
+    pixman_region32_fini (&b);
+    pixman_region32_fini (&c);
+}
+
+static void
+test_damage_history (void)
+{
+    pixman_region32_damage_t *damage;
+    pixman_region32_t frames[40];
+    pixman_region32_t expected, result;
+    prng_t prng;
+    int max_age, n, age, i;
+
+    prng_srand_r (&prng, 17);
+    pixman_region32_init (&expected);
+    pixman_region32_init (&result);
+
+    for (max_age = 1; max_age <= 9; max_age++)
+    {
+	damage = pixman_region32_damage_create (max_age);
+	assert (damage);
+
+	for (n = 0; n < 40; n++)
+	{
+	    random_region (&prng, &frames[n], prng_rand_r (&prng) % 20, 400);
+	    assert (pixman_region32_damage_add_frame (damage, &frames[n]));
+
+	    for (age = 0; age <= max_age + 1; age++)
+	    {
+		if (age > max_age || age > n + 1)
+		{
+		    assert (!pixman_region32_damage_since (damage, age, &result));
+		    continue;
+		}
+
+		pixman_region32_clear (&expected);
+		for (i = n - age + 1; i <= n; i++)
+		    pixman_region32_union (&expected, &expected, &frames[i]);
+
+		assert (pixman_region32_damage_since (damage, age, &result));
+		assert (same_region (&result, &expected));
+	    }
+	}
+
+	pixman_region32_damage_reset (damage);
+	assert (!pixman_region32_damage_since (damage, 1, &result));
+
+	for (n = 0; n < 40; n++)
+	    pixman_region32_fini (&frames[n]);
+
+	pixman_region32_damage_destroy (damage);
+    }
+
+    pixman_region32_fini (&expected);
+    pixman_region32_fini (&result);
+}
+
+static void
+test_spans (void)
+{
+    pixman_region32_span_t *spans, *chunked;
+    pixman_region32_span_iter_t iter;
+    pixman_region32_t a, b;
+    pixman_box32_t *boxes;
+    prng_t prng;
+    int i, j, n, n_boxes;
+
+    prng_srand_r (&prng, 19);
+
+    for (i = 0; i < 50; i++)
+    {
+	uint64_t n_spans;
+	int chunk;
+
+	random_region (&prng, &a, prng_rand_r (&prng) % 100, 300);
+	n_spans = pixman_region32_n_spans (&a);
+	spans = malloc ((n_spans + 1) * sizeof (pixman_region32_span_t));
+	chunked = malloc ((n_spans + 1) * sizeof (pixman_region32_span_t));
+
+	/* One span at a time */
+	n = 0;
+	pixman_region32_span_iter_init (&iter, &a);
+	while (pixman_region32_span_iter_next (&iter, &spans[n]))
+	    n++;
+	assert ((uint64_t)n == n_spans);
+
+	/* Every span is in the region, in y-x order, and together
+	 * they cover the region's area
+	 */
+	for (j = 0; j < n; j++)
+	{
+	    pixman_box32_t box = { spans[j].x1, spans[j].y, spans[j].x2, spans[j].y + 1 };
+
+	    assert (pixman_region32_contains_rectangle (&a, &box) == PIXMAN_REGION_IN);
+	    assert (j == 0 || spans[j].y > spans[j - 1].y ||
+		    (spans[j].y == spans[j - 1].y && spans[j].x1 > spans[j - 1].x2));
+	}
+
+	/* In chunks */
+	chunk = prng_rand_r (&prng) % 10 + 1;
+	n = 0;
+	pixman_region32_span_iter_init (&iter, &a);
+	while ((j = pixman_region32_span_iter_fill (&iter, chunked + n, chunk)))
+	    n += j;
+	assert ((uint64_t)n == n_spans);
+	assert (memcmp (spans, chunked, n * sizeof (pixman_region32_span_t)) == 0);
+
+	/* And back */
+	pixman_region32_init_spans (&b, spans, n);
+	assert (pixman_region32_selfcheck (&b));
+	assert (same_region (&a, &b));
+	pixman_region32_fini (&b);
+
+	/* Unsorted and overlapping spans */
+	for (j = 0; j < n; j++)
+	{
+	    pixman_region32_span_t tmp;
+	    int k = prng_rand_r (&prng) % n;
+
+	    tmp = spans[j];
+	    spans[j] = spans[k];
+	    spans[k] = tmp;
+	}
+	if (n)
+	    spans[n] = spans[0];
+	pixman_region32_init_spans (&b, spans, n ? n + 1 : 0);
+	assert (same_region (&a, &b));
+	pixman_region32_fini (&b);
+
+	free (spans);
+	free (chunked);
+	pixman_region32_fini (&a);
+    }
+
+    /* Touching and overlapping spans of a row are joined, and rows are
+     * coalesced into bands
+     */
+    {
+	pixman_region32_span_t row_spans[] = {
+	    { 5, 0, 10 }, { 5, 10, 20 }, { 5, 15, 18 }, { 5, 30, 40 },
+	    { 6, 0, 20 }, { 6, 30, 40 },
+	    { 8, 0, 20 },
+	};
+
+	pixman_region32_init_spans (&b, row_spans, 7);
+	boxes = pixman_region32_rectangles (&b, &n_boxes);
+	assert (n_boxes == 3);
+	assert (boxes[0].y1 == 5 && boxes[0].y2 == 7 && boxes[0].x2 == 20);
+	assert (boxes[1].y1 == 5 && boxes[1].y2 == 7 && boxes[1].x1 == 30);
+	assert (boxes[2].y1 == 8 && boxes[2].y2 == 9);
+	pixman_region32_fini (&b);
+    }
+}
+
+/* Pixel noise, or large boxes, anywhere around the origin */
+static void
+random_tiles_region (prng_t *prng, pixman_region32_t *region)
+{
+    int n = prng_rand_r (prng) % 300;
+    int size = (prng_rand_r (prng) & 1) ? 3 : 150;
+    int i;
+
+    pixman_region32_init (region);
+
+    for (i = 0; i < n; i++)
+    {
+	pixman_region32_union_rect (region, region,
+				    (int)(prng_rand_r (prng) % 400) - 200,
+				    (int)(prng_rand_r (prng) % 400) - 200,
+				    prng_rand_r (prng) % size + 1,
+				    prng_rand_r (prng) % size + 1);
+    }
+}
+
+static void
+test_tiles (void)
+{
+    pixman_region32_tiles_t *ta, *tb, *tc;
+    pixman_region32_t a, b, expected, result;
+    prng_t prng;
+    int i;
+
+    prng_srand_r (&prng, 23);
+    ta = pixman_region32_tiles_create ();
+    tb = pixman_region32_tiles_create ();
+    tc = pixman_region32_tiles_create ();
+    pixman_region32_init (&expected);
+
+    /* Tiles at the ends of the coordinate range */
+    for (i = 0; i < 2; i++)
+    {
+	if (i == 0)
+	    pixman_region32_init_rect (&a, INT32_MAX - 100, INT32_MAX - 70, 100, 70);
+	else
+	    pixman_region32_init_rect (&a, INT32_MIN, INT32_MIN, 3, 200);
+
+	assert (pixman_region32_tiles_from_region (ta, &a));
+	assert (pixman_region32_tiles_to_region (ta, &result));
+	assert (same_region (&result, &a));
+	pixman_region32_fini (&result);
+	pixman_region32_fini (&a);
+    }
+
+    for (i = 0; i < 100; i++)
+    {
+	random_tiles_region (&prng, &a);
+	random_tiles_region (&prng, &b);
+
+	assert (pixman_region32_tiles_from_region (ta, &a));
+	assert (pixman_region32_tiles_from_region (tb, &b));
+
+	assert (pixman_region32_tiles_to_region (ta, &result));
+	assert (pixman_region32_selfcheck (&result));
+	assert (same_region (&result, &a));
+	pixman_region32_fini (&result);
+
+	pixman_region32_union (&expected, &a, &b);
+	assert (pixman_region32_tiles_union (tc, ta, tb));
+	assert (pixman_region32_tiles_to_region (tc, &result));
+	assert (same_region (&result, &expected));
+	pixman_region32_fini (&result);
+
+	pixman_region32_intersect (&expected, &a, &b);
+	assert (pixman_region32_tiles_intersect (tc, ta, tb));
+	assert (pixman_region32_tiles_to_region (tc, &result));
+	assert (same_region (&result, &expected));
+	pixman_region32_fini (&result);
+
+	/* In place */
+	pixman_region32_subtract (&expected, &a, &b);
+	assert (pixman_region32_tiles_subtract (ta, ta, tb));
+	assert (pixman_region32_tiles_to_region (ta, &result));
+	assert (same_region (&result, &expected));
+	pixman_region32_fini (&result);
+
+	pixman_region32_fini (&a);
+	pixman_region32_fini (&b);
+    }
+
+    pixman_region32_fini (&expected);
+    pixman_region32_tiles_destroy (ta);
+    pixman_region32_tiles_destroy (tb);
+    pixman_region32_tiles_destroy (tc);
+}
+
+static int
+count_bands (pixman_region32_t *region)
+{
+    pixman_box32_t *boxes;
+    int i, n, n_bands = 0;
+
+    boxes = pixman_region32_rectangles (region, &n);
+    for (i = 0; i < n; i++)
+    {
+	if (i == 0 || boxes[i].y1 != boxes[i - 1].y1)
+	    n_bands++;
+    }
+
+    return n_bands;
+}
+
+/* Checks that table holds region, with the same bands and boxes rather
+ * than just the same coverage: to_region coalesces on its own, so it
+ * would hide bands that should have been merged.
+ */
+static void
+check_table (pixman_region32_table_t *table, pixman_region32_t *region)
+{
+    pixman_region32_t result;
+
+    assert (pixman_region32_table_n_bands (table) == count_bands (region));
+    assert (pixman_region32_table_n_spans (table) == pixman_region32_n_rects (region));
+
+    assert (pixman_region32_table_to_region (table, &result));
+    assert (pixman_region32_selfcheck (&result));
+    assert (same_region (&result, region));
+    pixman_region32_fini (&result);
+}
+
+static void
+test_table (void)
+{
+    pixman_region32_table_t *ta, *tb, *tc;
+    pixman_region32_t a, b, expected;
+    prng_t prng;
+    int i;
+
+    prng_srand_r (&prng, 29);
+    ta = pixman_region32_table_create ();
+    tb = pixman_region32_table_create ();
+    tc = pixman_region32_table_create ();
+    pixman_region32_init (&expected);
+
+    for (i = 0; i < 200; i++)
+    {
+	random_tiles_region (&prng, &a);
+	if (i % 10 == 0)
+	    pixman_region32_init (&b);
+	else
+	    random_tiles_region (&prng, &b);
+
+	assert (pixman_region32_table_from_region (ta, &a));
+	assert (pixman_region32_table_from_region (tb, &b));
+
+	check_table (ta, &a);
+	check_table (tb, &b);
+
+	pixman_region32_union (&expected, &a, &b);
+	assert (pixman_region32_table_union (tc, ta, tb));
+	check_table (tc, &expected);
+
+	pixman_region32_intersect (&expected, &a, &b);
+	assert (pixman_region32_table_intersect (tc, ta, tb));
+	check_table (tc, &expected);
+
+	pixman_region32_subtract (&expected, &b, &a);
+	assert (pixman_region32_table_subtract (tc, tb, ta));
+	check_table (tc, &expected);
+
+	/* In place */
+	pixman_region32_subtract (&expected, &a, &b);
+	assert (pixman_region32_table_subtract (ta, ta, tb));
+	check_table (ta, &expected);
+
+	pixman_region32_fini (&a);
+	pixman_region32_fini (&b);
+    }
+
+    pixman_region32_fini (&expected);
+    pixman_region32_table_destroy (ta);
+    pixman_region32_table_destroy (tb);
+    pixman_region32_table_destroy (tc);
+}
+
+static void
+test_serialize (void)
+{
+    pixman_region32_t a, b;
+    pixman_region16_t a16, b16;
+    uint8_t *buffer;
+    prng_t prng;
+    size_t size, used;
+    int i, j;
+
+    prng_srand_r (&prng, 29);
+
+    for (i = 0; i < 100; i++)
+    {
+	if (i == 0)
+	    pixman_region32_init (&a);
+	else if (i == 1)
+	    pixman_region32_init_rect (&a, INT32_MIN, INT32_MIN, UINT32_MAX, UINT32_MAX);
+	else
+	    random_tiles_region (&prng, &a);
+
+	size = pixman_region32_serialize (&a, NULL, 0);
+	if (i > 1)
+	    assert (size < 8 * (size_t)pixman_region32_n_rects (&a) + 4);
+	buffer = malloc (size + 1);
+	assert (pixman_region32_serialize (&a, buffer, size) == size);
+	buffer[size] = 0xff;
+
+	used = pixman_region32_deserialize (&b, buffer, size + 1);
+	assert (used == size);
+	assert (pixman_region32_selfcheck (&b));
+	assert (pixman_region32_equal (&a, &b) || !pixman_region32_not_empty (&a));
+	pixman_region32_fini (&b);
+
+	/* Truncated data is refused */
+	assert (pixman_region32_deserialize (&b, buffer, size - 1) == 0);
+	assert (!pixman_region32_not_empty (&b));
+	pixman_region32_fini (&b);
+
+	/* Corrupt data gives an error or some valid region */
+	for (j = 0; j < 10 && size > 2; j++)
+	{
+	    buffer[2 + prng_rand_r (&prng) % (size - 2)] = prng_rand_r (&prng);
+
+	    if (pixman_region32_deserialize (&b, buffer, size))
+		assert (pixman_region32_selfcheck (&b));
+	    pixman_region32_fini (&b);
+	}
+
+	free (buffer);
+	pixman_region32_fini (&a);
+    }
+
+    /* Touching bands with the same boxes are coalesced, so the result
+     * equals the canonical region covering the same area
+     */
+    {
+	static const uint8_t split[] = {
+	    4, 4,			/* 4 boxes in 4 bands */
+	    0, 4, 0, 0, 9,		/* y 0 to 5, x 0 to 10 */
+	    0, 4, 0, 0, 9,		/* y 5 to 10, the same */
+	    0, 4, 0, 0, 9,		/* y 10 to 15, the same */
+	    0, 4, 0, 4, 9,		/* y 15 to 20, x 2 to 12 */
+	};
+
+	assert (pixman_region32_deserialize (&b, split, sizeof (split)) == sizeof (split));
+	assert (pixman_region32_selfcheck (&b));
+	pixman_region32_init_rect (&a, 0, 0, 10, 15);
+	pixman_region32_union_rect (&a, &a, 2, 15, 10, 5);
+	assert (pixman_region32_equal (&a, &b));
+	assert (pixman_region32_n_rects (&b) == 2);
+	pixman_region32_fini (&a);
+	pixman_region32_fini (&b);
+    }
+
+    /* 16 bit regions use the same format */
+    pixman_region_init_rect (&a16, -5, -5, 10, 20);
+    pixman_region_union_rect (&a16, &a16, 20, 0, 10, 10);
+    size = pixman_region_serialize (&a16, NULL, 0);
+    buffer = malloc (size);
+    pixman_region_serialize (&a16, buffer, size);
+    assert (pixman_region_deserialize (&b16, buffer, size) == size);
+    assert (pixman_region_equal (&a16, &b16));
+    free (buffer);
+    pixman_region_fini (&a16);
+    pixman_region_fini (&b16);
+}
+
+static void
+test_flat (void)
+{
+    const pixman_region32_flat_t *flat;
+    pixman_region32_t a, b;
+    uint32_t *buffer;
+    prng_t prng;
+    size_t size;
+    int i, j;
+
+    prng_srand_r (&prng, 31);
+
+    for (i = 0; i < 50; i++)
+    {
+	random_tiles_region (&prng, &a);
+
+	size = pixman_region32_flat_size (&a);
+	buffer = malloc (size);
+	assert (pixman_region32_flat_write (&a, buffer, size - 1) == 0);
+	assert (pixman_region32_flat_write (&a, buffer, size) == size);
+
+	assert (!pixman_region32_flat_open (buffer, size - 1));
+	assert (!pixman_region32_flat_open ((uint8_t *)buffer + 1, size - 1));
+	flat = pixman_region32_flat_open (buffer, size);
+	assert (flat);
+
+	for (j = 0; j < 1000; j++)
+	{
+	    pixman_box32_t box1, box2, rect;
+	    int x = (int)(prng_rand_r (&prng) % 500) - 250;
+	    int y = (int)(prng_rand_r (&prng) % 500) - 250;
+
+	    assert (pixman_region32_flat_contains_point (flat, x, y, &box1) ==
+		    pixman_region32_contains_point (&a, x, y, &box2));
+	    if (pixman_region32_contains_point (&a, x, y, NULL))
+		assert (memcmp (&box1, &box2, sizeof (box1)) == 0);
+
+	    rect.x1 = x;
+	    rect.y1 = y;
+	    rect.x2 = x + prng_rand_r (&prng) % 20 + 1;
+	    rect.y2 = y + prng_rand_r (&prng) % 20 + 1;
+	    assert (pixman_region32_flat_contains_rectangle (flat, &rect) ==
+		    pixman_region32_contains_rectangle (&a, &rect));
+	}
+
+	assert (pixman_region32_init_flat (&b, flat));
+	assert (same_region (&a, &b));
+	pixman_region32_fini (&b);
+
+	/* Not a 32 bit flat region */
+	buffer[0] ^= 1;
+	assert (!pixman_region32_flat_open (buffer, size));
+
+	free (buffer);
+	pixman_region32_fini (&a);
+    }
+}
+
+static void
+test_band_iterators (void)
+{
+    pixman_region32_band_source_t sa, sb, sc;
+    pixman_region32_band_op_t op1, op2;
+    pixman_region32_band_iter_t *iter;
+    pixman_region32_t a, b, c, t, expected, result;
+    pixman_region16_band_source_t s16a, s16b;
+    pixman_region16_band_op_t op16;
+    pixman_region16_t a16, b16, r16;
+    prng_t prng;
+    int i, k;
+
+    prng_srand_r (&prng, 37);
+
+    for (i = 0; i < 200; i++)
+    {
+	random_tiles_region (&prng, &a);
+	random_tiles_region (&prng, &b);
+	random_tiles_region (&prng, &c);
+	if (i % 7 == 0)
+	    pixman_region32_clear (&c);
+	pixman_region32_init (&t);
+	pixman_region32_init (&expected);
+
+	for (k = 0; k < 3; k++)
+	{
+	    /* a op (b - c) */
+	    pixman_region32_band_source_init (&sa, &a);
+	    pixman_region32_band_source_init (&sb, &b);
+	    pixman_region32_band_source_init (&sc, &c);
+	    pixman_region32_band_subtract_init (&op1, &sb.iter, &sc.iter);
+	    pixman_region32_subtract (&t, &b, &c);
+
+	    if (k == 0)
+	    {
+		iter = pixman_region32_band_union_init (&op2, &sa.iter, &op1.iter);
+		pixman_region32_union (&expected, &a, &t);
+	    }
+	    else if (k == 1)
+	    {
+		iter = pixman_region32_band_intersect_init (&op2, &sa.iter, &op1.iter);
+		pixman_region32_intersect (&expected, &a, &t);
+	    }
+	    else
+	    {
+		iter = pixman_region32_band_subtract_init (&op2, &op1.iter, &sa.iter);
+		pixman_region32_subtract (&expected, &t, &a);
+	    }
+
+	    assert (pixman_region32_init_bands (&result, iter));
+	    assert (pixman_region32_selfcheck (&result));
+	    assert (same_region (&result, &expected));
+	    assert (pixman_region32_n_rects (&result) ==
+		    pixman_region32_n_rects (&expected));
+
+	    pixman_region32_band_op_fini (&op2);
+	    pixman_region32_band_op_fini (&op1);
+	    pixman_region32_fini (&result);
+	}
+
+	pixman_region32_fini (&a);
+	pixman_region32_fini (&b);
+	pixman_region32_fini (&c);
+	pixman_region32_fini (&t);
+	pixman_region32_fini (&expected);
+    }
+
+    pixman_region_init_rect (&a16, 0, 0, 10, 10);
+    pixman_region_init_rect (&b16, 5, 5, 10, 10);
+    pixman_region_band_union_init (&op16,
+				   pixman_region_band_source_init (&s16a, &a16),
+				   pixman_region_band_source_init (&s16b, &b16));
+    assert (pixman_region_init_bands (&r16, &op16.iter));
+    assert (pixman_region_n_rects (&r16) == 3);
+    pixman_region_band_op_fini (&op16);
+    pixman_region_fini (&a16);
+    pixman_region_fini (&b16);
+    pixman_region_fini (&r16);
+}
+
+static void
+test_xor (void)
+{
+    pixman_region32_band_source_t sa, sb;
+    pixman_region32_band_op_t op;
+    pixman_region32_t a, b, t, expected, result;
+    pixman_region16_t a16, b16, r16;
+    prng_t prng;
+    int i;
+
+    prng_srand_r (&prng, 44);
+
+    for (i = 0; i < 200; i++)
+    {
+	if (i % 2)
+	{
+	    random_tiles_region (&prng, &a);
+	    random_tiles_region (&prng, &b);
+	}
+	else
+	{
+	    random_region (&prng, &a, 100, 200);
+	    random_region (&prng, &b, i % 3 ? 100 : 1, 200);
+	}
+	pixman_region32_init (&t);
+	pixman_region32_init (&expected);
+	pixman_region32_init (&result);
+
+	/* (a - b) | (b - a) */
+	pixman_region32_subtract (&t, &a, &b);
+	pixman_region32_subtract (&expected, &b, &a);
+	pixman_region32_union (&expected, &expected, &t);
+
+	assert (pixman_region32_xor (&result, &a, &b));
+	assert (pixman_region32_selfcheck (&result));
+	assert (same_region (&result, &expected));
+	assert (pixman_region32_n_rects (&result) ==
+		pixman_region32_n_rects (&expected));
+
+	pixman_region32_band_xor_init (
+	    &op,
+	    pixman_region32_band_source_init (&sa, &a),
+	    pixman_region32_band_source_init (&sb, &b));
+	pixman_region32_fini (&result);
+	assert (pixman_region32_init_bands (&result, &op.iter));
+	assert (same_region (&result, &expected));
+	pixman_region32_band_op_fini (&op);
+
+	/* In place, and with itself */
+	assert (pixman_region32_xor (&a, &a, &b));
+	assert (same_region (&a, &expected));
+	assert (pixman_region32_xor (&result, &b, &b));
+	assert (!pixman_region32_not_empty (&result));
+
+	pixman_region32_fini (&a);
+	pixman_region32_fini (&b);
+	pixman_region32_fini (&t);
+	pixman_region32_fini (&expected);
+	pixman_region32_fini (&result);
+    }
+
+    /* Touching pieces from both sides are merged */
+    pixman_region_init_rect (&a16, 0, 0, 10, 10);
+    pixman_region_init_rect (&b16, 5, 0, 10, 20);
+    pixman_region_init (&r16);
+    assert (pixman_region_xor (&r16, &a16, &b16));
+    assert (pixman_region_n_rects (&r16) == 3);
+    assert (pixman_region_extents (&r16)->x1 == 0);
+    assert (pixman_region_extents (&r16)->x2 == 15);
+    assert (!pixman_region_contains_point (&r16, 7, 7, NULL));
+    assert (pixman_region_contains_point (&r16, 7, 17, NULL));
+    pixman_region_fini (&b16);
+
+    /* The shared parts are not in the extents */
+    pixman_region_init_rect (&b16, 0, 0, 10, 10);
+    pixman_region_union_rect (&a16, &a16, 20, 20, 5, 5);
+    pixman_region_union_rect (&b16, &b16, 20, 20, 5, 5);
+    pixman_region_subtract (&b16, &b16, &r16);
+    assert (pixman_region_xor (&r16, &a16, &b16));
+    assert (pixman_region_selfcheck (&r16));
+    assert (pixman_region_n_rects (&r16) == 1);
+    assert (pixman_region_extents (&r16)->x2 == 5);
+    assert (pixman_region_extents (&r16)->y2 == 10);
+    pixman_region_fini (&a16);
+    pixman_region_fini (&b16);
+    pixman_region_fini (&r16);
+}
+
+static void
+test_splice_rect (void)
+{
+    pixman_region32_t a, copy, orig, rect, expected, result;
+    pixman_box32_t *boxes;
+    prng_t prng;
+    int i, j, n;
+
+    prng_srand_r (&prng, 45);
+
+    for (i = 0; i < 100; i++)
+    {
+	if (i % 2)
+	    random_tiles_region (&prng, &a);
+	else
+	    random_region (&prng, &a, 50, 200);
+
+	pixman_region32_init (&expected);
+	pixman_region32_init (&result);
+
+	for (j = 0; j < 50; j++)
+	{
+	    int x = prng_rand_r (&prng) % 300 - 50;
+	    int y = prng_rand_r (&prng) % 300 - 50;
+	    int w = prng_rand_r (&prng) % (j % 5 ? 40 : 300);
+	    int h = prng_rand_r (&prng) % (j % 7 ? 40 : 300);
+
+	    pixman_region32_init_rect (&rect, x, y, w, h);
+
+	    /* Results must be the same, box for box, as the full
+	     * operation, and a region sharing the rectangles of the
+	     * source must not see the change.
+	     */
+	    pixman_region32_init (&copy);
+	    pixman_region32_copy (&copy, &a);
+	    boxes = pixman_region32_rectangles (&a, &n);
+	    pixman_region32_init_rects (&orig, boxes, n);
+
+	    if (j % 2)
+	    {
+		pixman_region32_union (&expected, &a, &rect);
+		assert (pixman_region32_union_rect (&result, &a, x, y, w, h));
+	    }
+	    else
+	    {
+		pixman_region32_subtract (&expected, &a, &rect);
+		assert (pixman_region32_subtract_rect (&result, &a, x, y, w, h));
+	    }
+
+	    assert (pixman_region32_selfcheck (&result));
+	    assert (same_region (&result, &expected));
+	    assert (pixman_region32_n_rects (&result) ==
+		    pixman_region32_n_rects (&expected));
+	    assert (pixman_region32_equal (&copy, &a));
+
+	    /* In place */
+	    if (j % 2)
+		assert (pixman_region32_union_rect (&a, &a, x, y, w, h));
+	    else
+		assert (pixman_region32_subtract_rect (&a, &a, x, y, w, h));
+
+	    assert (pixman_region32_selfcheck (&a));
+	    assert (same_region (&a, &expected));
+	    assert (same_region (&copy, &orig));
+
+	    pixman_region32_fini (&copy);
+	    pixman_region32_fini (&orig);
+	    pixman_region32_fini (&rect);
+	}
+
+	pixman_region32_fini (&a);
+	pixman_region32_fini (&expected);
+	pixman_region32_fini (&result);
+    }
+}
+
+static void
+test_union_rects (void)
+{
+    pixman_region32_t a, batch, expected, result;
+    pixman_box32_t boxes[300];
+    prng_t prng;
+    int i, j, n;
+
+    prng_srand_r (&prng, 46);
+
+    for (i = 0; i < 200; i++)
+    {
+	if (i % 2)
+	    random_tiles_region (&prng, &a);
+	else
+	    random_region (&prng, &a, i % 10 ? 100 : 0, 400);
+
+	/* Unsorted and overlapping, with some empty boxes, and now and
+	 * then a batch that is all in one band
+	 */
+	n = prng_rand_r (&prng) % 300;
+	for (j = 0; j < n; j++)
+	{
+	    boxes[j].x1 = prng_rand_r (&prng) % 500 - 50;
+	    boxes[j].y1 = i % 7 ? prng_rand_r (&prng) % 500 - 50 : 100;
+	    boxes[j].x2 = boxes[j].x1 + prng_rand_r (&prng) % 30;
+	    boxes[j].y2 = boxes[j].y1 + prng_rand_r (&prng) % 30;
+	}
+
+	pixman_region32_init_rects (&batch, boxes, n);
+	pixman_region32_init (&expected);
+	pixman_region32_union (&expected, &a, &batch);
+
+	pixman_region32_init (&result);
+	assert (pixman_region32_union_rects (&result, &a, boxes, n));
+	assert (pixman_region32_selfcheck (&result));
+	assert (same_region (&result, &expected));
+	assert (pixman_region32_n_rects (&result) ==
+		pixman_region32_n_rects (&expected));
+
+	assert (pixman_region32_union_rects (&a, &a, boxes, n));
+	assert (same_region (&a, &expected));
+
+	pixman_region32_fini (&a);
+	pixman_region32_fini (&batch);
+	pixman_region32_fini (&expected);
+	pixman_region32_fini (&result);
+    }
+}
+
+static void
+test_intersect_box (void)
+{
+    pixman_region32_t a, box, t, expected, result;
+    prng_t prng;
+    int i, j;
+
+    prng_srand_r (&prng, 47);
+
+    for (i = 0; i < 100; i++)
+    {
+	if (i % 2)
+	    random_tiles_region (&prng, &a);
+	else
+	    random_region (&prng, &a, 100, 400);
+
+	pixman_region32_init (&t);
+	pixman_region32_init (&expected);
+	pixman_region32_init (&result);
+
+	for (j = 0; j < 30; j++)
+	{
+	    int x = prng_rand_r (&prng) % 500 - 50;
+	    int y = prng_rand_r (&prng) % 500 - 50;
+	    int w = prng_rand_r (&prng) % (j % 3 ? 50 : 500) + 1;
+	    int h = prng_rand_r (&prng) % (j % 4 ? 50 : 500) + 1;
+
+	    /* a - (a - box) goes through pixman_op */
+	    pixman_region32_init_rect (&box, x, y, w, h);
+	    pixman_region32_subtract (&t, &a, &box);
+	    pixman_region32_subtract (&expected, &a, &t);
+
+	    assert (pixman_region32_intersect_rect (&result, &a, x, y, w, h));
+	    assert (pixman_region32_selfcheck (&result));
+	    assert (same_region (&result, &expected));
+	    assert (pixman_region32_n_rects (&result) ==
+		    pixman_region32_n_rects (&expected));
+
+	    /* The box region as destination */
+	    assert (pixman_region32_intersect (&box, &box, &a));
+	    assert (same_region (&box, &expected));
+
+	    pixman_region32_fini (&box);
+	}
+
+	pixman_region32_fini (&a);
+	pixman_region32_fini (&t);
+	pixman_region32_fini (&expected);
+	pixman_region32_fini (&result);
+    }
+}
+
+/* A band of many boxes against a band of a few, so that runs of boxes
+ * are skipped in both directions
+ */
+static void
+test_wide_bands (void)
+{
+    pixman_box32_t comb[1000];
+    pixman_box32_t *boxes;
+    pixman_region32_t a, b, r;
+    int i, n;
+
+    for (i = 0; i < 1000; i++)
+    {
+	comb[i].x1 = i * 10;
+	comb[i].y1 = 0;
+	comb[i].x2 = i * 10 + 5;
+	comb[i].y2 = 10;
+    }
+
+    pixman_region32_init_rects (&a, comb, 1000);
+    pixman_region32_init_rect (&b, 3000, 0, 20, 10);
+    pixman_region32_union_rect (&b, &b, 7000, 0, 3, 10);
+    pixman_region32_union_rect (&b, &b, 9990, 0, 100, 10);
+    pixman_region32_init (&r);
+
+    pixman_region32_intersect (&r, &a, &b);
+    boxes = pixman_region32_rectangles (&r, &n);
+    assert (n == 4);
+    assert (boxes[0].x1 == 3000 && boxes[0].x2 == 3005);
+    assert (boxes[1].x1 == 3010 && boxes[1].x2 == 3015);
+    assert (boxes[2].x1 == 7000 && boxes[2].x2 == 7003);
+    assert (boxes[3].x1 == 9990 && boxes[3].x2 == 9995);
+
+    pixman_region32_intersect (&r, &b, &a);
+    assert (pixman_region32_n_rects (&r) == 4);
+
+    pixman_region32_subtract (&r, &b, &a);
+    boxes = pixman_region32_rectangles (&r, &n);
+    assert (n == 3);
+    assert (boxes[0].x1 == 3005 && boxes[0].x2 == 3010);
+    assert (boxes[1].x1 == 3015 && boxes[1].x2 == 3020);
+    assert (boxes[2].x1 == 9995 && boxes[2].x2 == 10090);
+
+    pixman_region32_subtract (&r, &a, &b);
+    assert (pixman_region32_n_rects (&r) == 997);
+
+    pixman_region32_fini (&a);
+    pixman_region32_fini (&b);
+    pixman_region32_fini (&r);
+}
+
+/* Tall regions with long vertical gaps, and regions that only overlap
+ * in a thin slice, checked against the band iterators, which don't go
+ * through pixman_op ()
+ */
+static void
+test_tall_regions (void)
+{
+    pixman_region32_band_source_t sa, sb;
+    pixman_region32_band_op_t op;
+    pixman_region32_band_iter_t *iter;
+    pixman_region32_t a, b, expected, result;
+    pixman_box32_t boxes[200];
+    prng_t prng;
+    int i, j, k;
+
+    prng_srand_r (&prng, 49);
+
+    for (i = 0; i < 200; i++)
+    {
+	int offset = i % 3 ? prng_rand_r (&prng) % 200000 - 100000 : 0;
+
+	for (j = 0; j < 200; j++)
+	{
+	    boxes[j].x1 = prng_rand_r (&prng) % 1000;
+	    boxes[j].y1 = prng_rand_r (&prng) % (j % 4 ? 100000 : 500);
+	    boxes[j].x2 = boxes[j].x1 + prng_rand_r (&prng) % 100 + 1;
+	    boxes[j].y2 = boxes[j].y1 + prng_rand_r (&prng) % 100 + 1;
+	}
+	pixman_region32_init_rects (&a, boxes, 200);
+
+	for (j = 0; j < 200; j++)
+	{
+	    boxes[j].y1 += offset;
+	    boxes[j].y2 += offset;
+	    boxes[j].x1 += j % 50;
+	}
+	pixman_region32_init_rects (&b, boxes, 100 + i % 100);
+
+	for (k = 0; k < 4; k++)
+	{
+	    pixman_region32_init (&result);
+
+	    pixman_region32_band_source_init (&sa, &a);
+	    pixman_region32_band_source_init (&sb, &b);
+
+	    if (k == 0)
+	    {
+		iter = pixman_region32_band_union_init (&op, &sa.iter, &sb.iter);
+		pixman_region32_union (&result, &a, &b);
+	    }
+	    else if (k == 1)
+	    {
+		iter = pixman_region32_band_intersect_init (&op, &sa.iter, &sb.iter);
+		pixman_region32_intersect (&result, &a, &b);
+	    }
+	    else if (k == 2)
+	    {
+		iter = pixman_region32_band_subtract_init (&op, &sb.iter, &sa.iter);
+		pixman_region32_subtract (&result, &b, &a);
+	    }
+	    else
+	    {
+		iter = pixman_region32_band_xor_init (&op, &sa.iter, &sb.iter);
+		pixman_region32_xor (&result, &a, &b);
+	    }
+
+	    assert (pixman_region32_init_bands (&expected, iter));
+	    assert (pixman_region32_selfcheck (&result));
+	    assert (same_region (&result, &expected));
+	    assert (pixman_region32_n_rects (&result) ==
+		    pixman_region32_n_rects (&expected));
+
+	    pixman_region32_band_op_fini (&op);
+	    pixman_region32_fini (&expected);
+	    pixman_region32_fini (&result);
+	}
+
+	pixman_region32_fini (&a);
+	pixman_region32_fini (&b);
+    }
+}
+
+#ifdef __SIZEOF_INT128__
+/* Copy of a 32 bit region moved by (dx, dy), which may be beyond the 32
+ * bit range
+ */
+static void
+region64_from_region32 (pixman_region64_t *dst, pixman_region32_t *src,
+			int64_t dx, int64_t dy)
+{
+    pixman_box32_t *boxes;
+    pixman_box64_t *boxes64;
+    int i, n;
+
+    boxes = pixman_region32_rectangles (src, &n);
+    boxes64 = malloc ((n + 1) * sizeof (pixman_box64_t));
+
+    for (i = 0; i < n; i++)
+    {
+	boxes64[i].x1 = boxes[i].x1 + dx;
+	boxes64[i].y1 = boxes[i].y1 + dy;
+	boxes64[i].x2 = boxes[i].x2 + dx;
+	boxes64[i].y2 = boxes[i].y2 + dy;
+    }
+
+    assert (pixman_region64_init_rects (dst, boxes64, n));
+    free (boxes64);
+}
+
+static pixman_bool_t
+same_region64 (pixman_region64_t *a, pixman_region32_t *b,
+	       int64_t dx, int64_t dy)
+{
+    pixman_region64_t c;
+    pixman_bool_t same;
+
+    region64_from_region32 (&c, b, dx, dy);
+    same = (!pixman_region64_not_empty (a) && !pixman_region64_not_empty (&c)) ||
+	pixman_region64_equal (a, &c);
+    pixman_region64_fini (&c);
+
+    return same;
+}
+
+static void
+test_region64 (void)
+{
+    const int64_t far = (int64_t)1 << 40;
+    pixman_region32_t a, b, r;
+    pixman_region64_t a64, b64, r64;
+    pixman_box64_t box;
+    uint8_t *buffer;
+    size_t size;
+    prng_t prng;
+    int i;
+
+    prng_srand_r (&prng, 41);
+
+    for (i = 0; i < 100; i++)
+    {
+	random_tiles_region (&prng, &a);
+	random_tiles_region (&prng, &b);
+	pixman_region32_init (&r);
+	pixman_region64_init (&r64);
+
+	region64_from_region32 (&a64, &a, far, -far);
+	region64_from_region32 (&b64, &b, far, -far);
+	assert (pixman_region64_selfcheck (&a64));
+
+	pixman_region32_union (&r, &a, &b);
+	pixman_region64_union (&r64, &a64, &b64);
+	assert (same_region64 (&r64, &r, far, -far));
+
+	pixman_region32_intersect (&r, &a, &b);
+	pixman_region64_intersect (&r64, &a64, &b64);
+	assert (same_region64 (&r64, &r, far, -far));
+
+	pixman_region32_subtract (&r, &a, &b);
+	pixman_region64_subtract (&r64, &a64, &b64);
+	assert (same_region64 (&r64, &r, far, -far));
+	assert (pixman_region64_area (&r64) == pixman_region32_area (&r));
+	assert (pixman_region64_contains_point (&r64, far, -far, NULL) ==
+		pixman_region32_contains_point (&r, 0, 0, NULL));
+
+	pixman_region64_translate (&r64, -far, far);
+	assert (same_region64 (&r64, &r, 0, 0));
+
+	/* Serialization */
+	pixman_region64_translate (&r64, INT64_MAX - far, INT64_MIN + far);
+	size = pixman_region64_serialize (&r64, NULL, 0);
+	buffer = malloc (size);
+	assert (pixman_region64_serialize (&r64, buffer, size) == size);
+	pixman_region64_fini (&a64);
+	assert (pixman_region64_deserialize (&a64, buffer, size) == size);
+	assert (pixman_region64_equal (&a64, &r64) || !pixman_region64_not_empty (&r64));
+	free (buffer);
+
+	pixman_region32_fini (&a);
+	pixman_region32_fini (&b);
+	pixman_region32_fini (&r);
+	pixman_region64_fini (&a64);
+	pixman_region64_fini (&b64);
+	pixman_region64_fini (&r64);
+    }
+
+    /* The whole coordinate range */
+    box.x1 = box.y1 = INT64_MIN;
+    box.x2 = box.y2 = INT64_MAX;
+    pixman_region64_init_with_extents (&a64, &box);
+    pixman_region64_init_rect (&b64, -10, -10, 20, 20);
+    pixman_region64_init (&r64);
+    pixman_region64_subtract (&r64, &a64, &b64);
+    assert (pixman_region64_n_rects (&r64) == 4);
+    assert (!pixman_region64_contains_point (&r64, 0, 0, NULL));
+    assert (pixman_region64_contains_point (&r64, INT64_MIN, INT64_MAX - 1, NULL));
+
+    size = pixman_region64_serialize (&r64, NULL, 0);
+    buffer = malloc (size);
+    pixman_region64_serialize (&r64, buffer, size);
+    pixman_region64_fini (&b64);
+    assert (pixman_region64_deserialize (&b64, buffer, size) == size);
+    assert (pixman_region64_equal (&b64, &r64));
+    free (buffer);
+
+    /* Translating out of range clips */
+    pixman_region64_translate (&r64, INT64_MAX / 2, 0);
+    assert (pixman_region64_selfcheck (&r64));
+    assert (pixman_region64_extents (&r64)->x2 == INT64_MAX);
+    assert (pixman_region64_contains_point (&r64, INT64_MAX - 1, 0, NULL));
+
+    pixman_region64_fini (&a64);
+    pixman_region64_fini (&b64);
+    pixman_region64_fini (&r64);
+
+    /* Boxes and rectangles wider than 32 bits */
+    box.x1 = 0;
+    box.y1 = 0;
+    box.x2 = ((int64_t)1 << 33) + 5;
+    box.y2 = 10;
+    pixman_region64_init_rects (&a64, &box, 1);
+    assert (pixman_region64_extents (&a64)->x2 == box.x2);
+    pixman_region64_init_rect (&b64, 0, 0, (uint64_t)1 << 33, 10);
+    assert (pixman_region64_extents (&b64)->x2 == (int64_t)1 << 33);
+    pixman_region64_init (&r64);
+    pixman_region64_subtract (&r64, &a64, &b64);
+    assert (pixman_region64_area (&r64) == 50);
+    pixman_region64_union_rect (&r64, &b64, 0, 10, (uint64_t)1 << 40, (uint64_t)1 << 40);
+    assert (pixman_region64_extents (&r64)->y2 == ((int64_t)1 << 40) + 10);
+
+    /* Rectangles reaching past the range are clipped to it */
+    pixman_region64_union_rect (&r64, &r64, INT64_MAX - 5, 0, 10, 10);
+    assert (pixman_region64_selfcheck (&r64));
+    assert (pixman_region64_extents (&r64)->x2 == INT64_MAX);
+    assert (pixman_region64_contains_point (&r64, INT64_MAX - 1, 5, NULL));
+
+    pixman_region64_fini (&a64);
+    pixman_region64_fini (&b64);
+    pixman_region64_fini (&r64);
+}
+#endif
+
 int
 main ()
 {
@@ -122,5 +1808,36 @@ main ()
     pixman_image_unref (fill);
 #endif
 
+    test_copy_on_write ();
+    test_hash ();
+    test_area ();
+    test_simplify ();
+    test_damage_history ();
+    test_spans ();
+    test_tiles ();
+    test_table ();
+    test_serialize ();
+    test_flat ();
+    test_band_iterators ();
+    test_xor ();
+    test_splice_rect ();
+    test_union_rects ();
+    test_intersect_box ();
+    test_wide_bands ();
+    test_tall_regions ();
+    test_region_expr ();
+    test_basic_region ();
+#ifdef __SIZEOF_INT128__
+    test_region64 ();
+#endif
+
+#ifdef HAVE_PTHREADS
+    test_concurrent_regions ();
+#endif
+
+    test_parallel_ops ();
+    test_union_many ();
+    test_init_rects_parallel ();
+
     return 0;
 }